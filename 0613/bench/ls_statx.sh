@@ -0,0 +1,78 @@
+#!/bin/sh
+# c_ls의 항목 stat 일괄 처리(io_uring IORING_OP_STATX)와 동기 statx 루프를 비교한다.
+# 항목 N개짜리 디렉터리 하나를 만들어 -S(크기순, 항목마다 statx 필요)와 -l로 나열하고,
+# 경과 시간과 시스템 호출 수를 잰다.
+#
+# 사용법: sh bench/ls_statx.sh [N] [DIR]   (0613 디렉터리에서 실행)
+#   N    항목 수 (기본 1000000)
+#   DIR  디렉터리를 만들 곳 (기본 mktemp -d). 측정할 파일 시스템 위에 두어야 한다.
+# root이면 /proc/sys/vm/drop_caches로 캐시를 비운 "cold" 측정도 한다.
+# 시스템 호출 수는 strace -c -f가 있으면 그것으로, 없으면 bench/syscount.c(ptrace)로 센다.
+# 링 빌드는 -DC_LS_FORCE_URING이므로 CPU가 하나여도 링을 쓴다. (기본 빌드는 CPU가 둘 이상일 때만)
+set -eu
+
+n=${1:-1000000}
+base=${2:-}
+cd "$(dirname "$0")/.."
+tmp=$(mktemp -d)
+[ -n "$base" ] || base=$tmp
+dir="$base/ls_statx.$$"
+trap 'rm -rf "$dir" "$tmp"' EXIT
+
+gcc -O2 -pthread -DC_LS_FORCE_URING -o "$tmp/c_ls_ring" c_ls.c
+gcc -O2 -pthread -DC_LS_NO_URING -o "$tmp/c_ls_sync" c_ls.c
+command -v strace > /dev/null || gcc -O2 -o "$tmp/syscount" bench/syscount.c
+
+echo "creating $n entries in $dir ..."
+mkdir "$dir"
+(cd "$dir" && seq -f 'f%.0f' 1 "$n" | xargs touch)
+
+# best_of 횟수 명령...: 가장 짧은 경과 시간(초)
+best_of() {
+    runs=$1
+    shift
+    best=
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        [ -n "${cold:-}" ] && sync && echo 3 > /proc/sys/vm/drop_caches
+        start=$(date +%s.%N)
+        "$@" > /dev/null
+        end=$(date +%s.%N)
+        t=$(awk "BEGIN { print $end - $start }")
+        if [ -z "$best" ] || awk "BEGIN { exit !($t < $best) }"; then best=$t; fi
+        i=$((i + 1))
+    done
+    printf '%.3f' "$best"
+}
+
+printf '%-6s %-5s %10s %10s\n' flags cache sync io_uring
+for flags in -S -l; do
+    cold=
+    printf '%-6s %-5s %10s %10s\n' "$flags" warm \
+        "$(best_of 3 "$tmp/c_ls_sync" $flags "$dir")" "$(best_of 3 "$tmp/c_ls_ring" $flags "$dir")"
+    if [ "$(id -u)" = 0 ] && [ -w /proc/sys/vm/drop_caches ]; then
+        cold=1
+        printf '%-6s %-5s %10s %10s\n' "$flags" cold \
+            "$(best_of 3 "$tmp/c_ls_sync" $flags "$dir")" "$(best_of 3 "$tmp/c_ls_ring" $flags "$dir")"
+    fi
+done
+
+# syscalls 명령...: "전체 statx io_uring_enter" 시스템 호출 수 (모든 스레드 합)
+syscalls() {
+    if command -v strace > /dev/null; then
+        strace -f -c -o "$tmp/strace.out" "$@" > /dev/null
+        awk '$NF == "total" { t = $4 } $NF == "statx" { s = $4 } $NF == "io_uring_enter" { u = $4 }
+             END { printf "%s %s %s", t, s + 0, u + 0 }' "$tmp/strace.out"
+    else
+        "$tmp/syscount" "$@" 2>&1 > /dev/null | awk '{ printf "%s %s %s", $2, $4, $6 }'
+    fi
+}
+
+echo
+printf '%-6s %-8s %10s %10s %15s\n' flags build syscalls statx io_uring_enter
+for flags in -S -l; do
+    for build in sync ring; do
+        set -- $(syscalls "$tmp/c_ls_$build" $flags "$dir")
+        printf '%-6s %-8s %10s %10s %15s\n' "$flags" "$build" "$1" "$2" "$3"
+    done
+done
@@ -0,0 +1,94 @@
+#!/bin/sh
+# c_rm -r의 직렬 walker(-j1)와 작업 훔치기 병렬 삭제(-j2, -j4)를 비교한다.
+# 측정마다 같은 모양의 트리를 새로 만들고 그 트리를 지우는 시간만 잰다.
+#
+# 사용법: sh bench/rm_tree.sh [DIR]   (0613 디렉터리에서 실행)
+#   DIR  트리를 만들 곳 (기본 mktemp -d). 측정할 파일 시스템 위에 두어야 한다.
+# 트리 모양 (user-043 커밋 표와 같다):
+#   fan-out 4, depth 6, 디렉터리마다 파일 20개
+#   fan-out 50, depth 2, 디렉터리마다 파일 40개
+#   깊이 2000짜리 사슬, 디렉터리마다 파일 10개
+set -eu
+
+base=${1:-}
+cd "$(dirname "$0")/.."
+tmp=$(mktemp -d)
+[ -n "$base" ] || base=$tmp
+work="$base/rm_tree.$$"
+trap 'rm -rf "$work" "$tmp"' EXIT
+
+gcc -O2 -pthread -o "$tmp/c_rm" c_rm.c
+mkdir "$work"
+tree="$work/tree"
+
+# make_fanout fan-out depth 파일수: $tree에 모든 디렉터리에 파일을 둔 완전 트리를 만든다.
+make_fanout() {
+    mkdir "$tree"
+    (cd "$tree" && awk -v f="$1" -v d="$2" -v n="$3" '
+        function emit(p, i) { for (i = 0; i < n; i++) print p "/f" i > "files" }
+        BEGIN {
+            emit(".")
+            cnt = 1; cur[0] = "."
+            for (l = 0; l < d; l++) {
+                m = 0
+                for (c = 0; c < cnt; c++)
+                    for (k = 0; k < f; k++) {
+                        p = cur[c] "/d" k
+                        print p > "dirs"
+                        emit(p)
+                        nxt[m++] = p
+                    }
+                delete cur
+                for (c = 0; c < m; c++) cur[c] = nxt[c]
+                delete nxt
+                cnt = m
+            }
+        }' &&
+        xargs mkdir < dirs && xargs touch < files && rm dirs files)
+}
+
+# make_chain depth 파일수: $tree에 한 줄로 이어진 사슬을 만든다.
+# 경로가 PATH_MAX를 넘지 않도록 한 단계씩 cd 하면서 만든다.
+make_chain() {
+    mkdir "$tree"
+    (cd "$tree" && i=0 && while [ "$i" -lt "$1" ]; do
+        j=0
+        while [ "$j" -lt "$2" ]; do : > "f$j"; j=$((j + 1)); done
+        mkdir d && cd d
+        i=$((i + 1))
+    done)
+}
+
+# best_of 횟수 트리생성명령...: 트리를 만들고 c_rm -r $jobs로 지우는 가장 짧은 시간(초)
+best_of() {
+    runs=$1
+    shift
+    best=
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        "$@"
+        sync
+        start=$(date +%s.%N)
+        "$tmp/c_rm" -r $jobs "$tree"
+        end=$(date +%s.%N)
+        t=$(awk "BEGIN { print $end - $start }")
+        if [ -z "$best" ] || awk "BEGIN { exit !($t < $best) }"; then best=$t; fi
+        i=$((i + 1))
+    done
+    printf '%.2f' "$best"
+}
+
+row() {
+    label=$1
+    shift
+    out=
+    for jobs in -j1 -j2 -j4; do
+        out="$out $(printf '%6s' "$(best_of 3 "$@")")"
+    done
+    printf '%-34s%s\n' "$label" "$out"
+}
+
+printf '%-34s %6s %6s %6s\n' tree -j1 -j2 -j4
+row "fan-out 4, depth 6, 20 files/dir" make_fanout 4 6 20
+row "fan-out 50, depth 2, 40 files/dir" make_fanout 50 2 40
+row "chain depth 2000, 10 files/dir" make_chain 2000 10
@@ -0,0 +1,82 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>     // for exit
+#include <signal.h>     // for raise, SIGSTOP
+#include <unistd.h>     // for fork, execvp
+#include <errno.h>      // for errno
+#include <sys/ptrace.h> // for ptrace, PTRACE_GET_SYSCALL_INFO
+#include <sys/wait.h>   // for waitpid
+#include <sys/syscall.h> // for SYS_* 번호
+
+// strace -c -f가 없는 환경에서 쓰는 시스템 호출 세기. (bench/ls_statx.sh가 씀)
+// 명령을 실행하면서 모든 스레드의 시스템 호출 진입을 세어, 끝나면 표준 오류로 출력한다.
+// 사용법: syscount 명령 [인자...]
+//
+// PTRACE_GET_SYSCALL_INFO(리눅스 5.3 이상)로 진입/복귀를 구별하므로 스레드마다 상태를 둘
+// 필요가 없다. io_uring에 올린 요청은 커널 안에서 처리되므로 io_uring_enter 한 번으로 세어진다.
+
+#define MAX_SYSCALL 1024
+
+static unsigned long long g_counts[MAX_SYSCALL];
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "사용법: %s 명령 [인자...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pid_t child = fork();
+    if (child == -1) {
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+    if (child == 0) {
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP); // 부모가 옵션을 정할 때까지 멈춘다.
+        execvp(argv[1], argv + 1);
+        perror(argv[1]);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(child, &status, 0) == -1 || !WIFSTOPPED(status)) {
+        perror("waitpid");
+        return EXIT_FAILURE;
+    }
+    long options = PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK |
+                   PTRACE_O_TRACEVFORK | PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL;
+    if (ptrace(PTRACE_SETOPTIONS, child, NULL, (void *)options) == -1) {
+        perror("ptrace");
+        return EXIT_FAILURE;
+    }
+    ptrace(PTRACE_SYSCALL, child, NULL, NULL);
+
+    int exit_code = EXIT_FAILURE;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, __WALL)) != -1) {
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            if (pid == child) exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            continue;
+        }
+        int sig = WSTOPSIG(status);
+        if (sig == (SIGTRAP | 0x80)) {
+            // 시스템 호출 정지: 진입일 때만 센다.
+            struct __ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, pid, (void *)sizeof(info), &info) > 0 &&
+                info.op == PTRACE_SYSCALL_INFO_ENTRY && info.entry.nr < MAX_SYSCALL) {
+                g_counts[info.entry.nr]++;
+            }
+            sig = 0;
+        } else if ((status >> 16) != 0 || sig == SIGSTOP) {
+            sig = 0; // clone/exec 이벤트 정지, 새 스레드의 첫 정지는 신호가 아니다.
+        }
+        ptrace(PTRACE_SYSCALL, pid, NULL, (void *)(long)sig);
+    }
+    if (errno != ECHILD) perror("waitpid");
+
+    unsigned long long total = 0;
+    for (int i = 0; i < MAX_SYSCALL; i++) total += g_counts[i];
+    fprintf(stderr, "syscalls %llu statx %llu io_uring_enter %llu getdents64 %llu\n", total,
+            g_counts[SYS_statx], g_counts[SYS_io_uring_enter], g_counts[SYS_getdents64]);
+    return exit_code;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE      // for pthread_condattr_setclock
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,6 +6,82 @@
 #include <sys/statvfs.h> // statvfs 구조체 및 함수
 #include <mntent.h>      // getmntent, setmntent, endmntent (마운트 정보)
 #include <stdint.h>      // uint64_t 등 정확한 크기의 정수 타입
+#include <getopt.h>      // getopt_long (--timeout, --slow-mount)
+#include <pthread.h>     // statvfs 작업 스레드
+#include <stdatomic.h>   // 작업 묶음의 참조 수
+#include <time.h>        // clock_gettime (마운트별 제한 시간)
+#include <fcntl.h>       // open (/proc/self/mountinfo)
+#include <poll.h>        // poll (--watch: 마운트 테이블 변경 감지)
+#include <errno.h>       // EINTR
+
+// 응답하지 않는 NFS/FUSE 마운트에서는 statvfs()가 영원히 돌아오지 않을 수 있다.
+// 그래서 statvfs를 작업 스레드에서 부르고, 제한 시간이 지난 마운트는 기다리지 않고 "?"로 찍는다.
+
+#define DF_DEFAULT_JOBS 4           // statvfs는 CPU가 아니라 응답을 기다리는 일이므로 CPU 수와 무관하게 작게 둔다.
+#define DF_DEFAULT_TIMEOUT 5.0      // 마운트 하나의 statvfs 제한 시간 (초)
+#define SLOW_MOUNT_SECONDS 3600     // --slow-mount로 고른 마운트가 멈춰 있는 시간
+#define WATCH_EWMA_ALPHA 0.3        // --watch: 증가 속도 지수 평활 계수 (클수록 최근 구간을 더 믿음)
+
+// 명령줄 옵션을 담는 구조체
+typedef struct {
+    int human_readable;     // -h: 사람이 읽기 쉬운 단위로 표시
+    int show_type;          // -T: 파일 시스템 타입 표시
+    int show_all;           // -a: 모든 파일 시스템 표시 (pseudo 포함)
+    int jobs;               // -j N: statvfs를 동시에 부르는 스레드 수
+    double timeout;         // --timeout SECS: 마운트별 제한 시간 (0이면 끝날 때까지 기다림)
+    const char *slow_mount; // --slow-mount DIR: (시험용) 이 마운트의 statvfs를 일부러 멈춘다
+    double watch_interval;  // --watch SECS: 이 간격으로 계속 표본을 뜬다 (0이면 한 번만 출력)
+    int iterations;         // -n COUNT: --watch에서 출력할 횟수 (0이면 무한)
+} DfOptions;
+
+// statvfs 결과 상태
+enum { STAT_PENDING, STAT_RUNNING, STAT_OK, STAT_FAILED, STAT_TIMEDOUT };
+
+typedef struct {
+    char *dir;
+    int state;
+    struct timespec started;    // STAT_RUNNING이 된 시각 (CLOCK_MONOTONIC, 제한 시간의 기준)
+    int returned;               // STAT_TIMEDOUT이 된 뒤 statvfs가 결국 돌아왔는지
+    struct statvfs st;
+} StatJob;
+
+/**
+ * statvfs 한 번의 작업 묶음.
+ * 제한 시간을 넘긴 스레드는 버려 두고 먼저 결과를 출력하므로, 묶음은 main이 아니라
+ * 마지막으로 놓는 쪽(멈춰 있던 스레드일 수도 있음)이 해제한다.
+ */
+typedef struct {
+    StatJob *jobs;
+    size_t count;
+    size_t next;                // 다음에 가져갈 작업
+    size_t finished;            // STAT_OK/FAILED/TIMEDOUT이 된 작업 수
+    atomic_int refs;            // main + 살아 있는 작업 스레드 수
+    const char *slow_mount;
+    pthread_mutex_t lock;       // 위의 next, finished, 각 작업의 state/st를 보호
+    pthread_cond_t changed;     // 작업이 끝날 때 알림
+} StatRound;
+
+// 출력할 마운트 하나 (마운트 테이블 순서대로 배열에 담는다)
+typedef struct {
+    char *fsname;
+    char *dir;
+    char *type;
+
+    // --watch: 이전 표본과 추세 (마운트 테이블을 다시 읽어도 같은 마운트면 이어받는다)
+    int sampled;                // 이전 표본이 있는지
+    double sample_time;         // 표본 시각 (CLOCK_MONOTONIC, 초)
+    uint64_t used_bytes;
+    uint64_t used_inodes;
+    int have_rate;              // 아래 속도가 한 구간 이상 쌓였는지
+    double byte_rate;           // 마지막 구간의 사용량 증가 속도 (바이트/초)
+    double inode_rate;          // 마지막 구간의 inode 증가 속도 (개/초)
+    double smoothed_rate;       // byte_rate의 지수 평활 값 (가득 찰 때까지 남은 시간 추정용)
+
+    // 제한 시간을 넘긴 statvfs가 아직 돌아오지 않았으면 그 작업 (참조를 쥐고 있음).
+    // 같은 마운트에 스레드를 틱마다 하나씩 더 묶어 두지 않도록 돌아올 때까지 다시 부르지 않는다.
+    StatRound *hung;
+    size_t hung_index;
+} MountInfo;
 
 /**
  * @brief 바이트 단위 크기를 사람이 읽기 쉬운 K, M, G, T 단위로 변환하여 출력
@@ -29,27 +106,21 @@ void print_human_readable(uint64_t bytes) {
     printf("%5.1f%s", size, units[i]);
 }
 
-// 메인 함수
-int main(int argc, char *argv[]) {
-    // 옵션 상태를 저장할 플래그 변수
-    int human_readable = 0; // -h: 사람이 읽기 쉬운 단위로 표시
-    int show_type = 0;      // -T: 파일 시스템 타입 표시
-    int show_all = 0;       // -a: 모든 파일 시스템 표시 (pseudo 포함)
-
-    int opt;
-    // getopt를 사용하여 명령줄 옵션을 파싱
-    while ((opt = getopt(argc, argv, "hTa")) != -1) {
-        switch (opt) {
-            case 'h': human_readable = 1; break;
-            case 'T': show_type = 1;      break;
-            case 'a': show_all = 1;       break;
-            default:
-                fprintf(stderr, "사용법: %s [-hTa]\n", argv[0]);
-                exit(EXIT_FAILURE);
-        }
-    }
+static int is_pseudo_fs(const struct mntent *m) {
+    // 보통 장치 이름이 'none'이거나, 타입이 'tmpfs', 'proc' 등인 경우가 해당된다.
+    return strcmp(m->mnt_type, "proc") == 0 ||
+           strcmp(m->mnt_type, "sysfs") == 0 ||
+           strcmp(m->mnt_type, "devtmpfs") == 0 ||
+           strcmp(m->mnt_type, "tmpfs") == 0 ||
+           strcmp(m->mnt_fsname, "none") == 0;
+}
 
-    // /proc/mounts 파일을 열어 마운트된 파일 시스템 목록을 가져온다.
+/**
+ * @brief /proc/mounts에서 출력할 마운트 목록을 읽습니다.
+ * @param count 마운트 수를 저장
+ * @return malloc한 배열 (free_mounts로 해제)
+ */
+static MountInfo *read_mounts(const DfOptions *opts, size_t *count) {
     // 이 파일은 현재 시스템에 마운트된 모든 파일 시스템의 정보를 담고 있다.
     FILE *mount_table = setmntent("/proc/mounts", "r");
     if (!mount_table) {
@@ -57,70 +128,573 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    MountInfo *mounts = NULL;
+    size_t n = 0, cap = 0;
     struct mntent *mount_entry; // 마운트 항목 하나를 가리키는 포인터
-    
-    // 헤더 출력
-    printf("%-20s", "Filesystem");
-    if (show_type) printf(" %-10s", "Type");
-    printf(" %10s %10s %10s %5s %-s\n", "Size", "Used", "Avail", "Use%", "Mounted on");
-
-    // getmntent()를 반복 호출하여 마운트된 모든 파일 시스템을 순회
     while ((mount_entry = getmntent(mount_table)) != NULL) {
-        
-        // --- -a 옵션 필터링 ---
-        // -a 옵션이 없고, 가상/임시 파일 시스템(pseudo-filesystem)이면 건너뛴다.
-        // 보통 장치 이름이 'none'이거나, 타입이 'tmpfs', 'proc' 등인 경우가 해당된다.
-        if (!show_all && (
-            strcmp(mount_entry->mnt_type, "proc") == 0 ||
-            strcmp(mount_entry->mnt_type, "sysfs") == 0 ||
-            strcmp(mount_entry->mnt_type, "devtmpfs") == 0 ||
-            strcmp(mount_entry->mnt_type, "tmpfs") == 0 ||
-            strcmp(mount_entry->mnt_fsname, "none") == 0
-        )) {
-            continue;
+        // -a 옵션이 없으면 가상/임시 파일 시스템(pseudo-filesystem)은 건너뛴다.
+        if (!opts->show_all && is_pseudo_fs(mount_entry)) continue;
+
+        if (n == cap) {
+            cap = cap ? cap * 2 : 32;
+            mounts = realloc(mounts, cap * sizeof(MountInfo));
+            if (!mounts) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
         }
+        memset(&mounts[n], 0, sizeof(MountInfo));
+        mounts[n].fsname = strdup(mount_entry->mnt_fsname);
+        mounts[n].dir = strdup(mount_entry->mnt_dir);
+        mounts[n].type = strdup(mount_entry->mnt_type);
+        if (!mounts[n].fsname || !mounts[n].dir || !mounts[n].type) {
+            perror("strdup");
+            exit(EXIT_FAILURE);
+        }
+        n++;
+    }
+    endmntent(mount_table);
+    *count = n;
+    return mounts;
+}
 
-        struct statvfs fs_stats; // 파일 시스템 통계 정보를 담을 구조체
+// --- 동시 statvfs ---
 
-        // statvfs() 시스템 호출로 마운트된 디렉터리의 통계 정보를 가져온다.
-        if (statvfs(mount_entry->mnt_dir, &fs_stats) != 0) {
-            // 실패 시 해당 항목은 건너뛴다 (예: 접근 권한 없는 경우)
+static void round_release(StatRound *r) {
+    if (atomic_fetch_sub(&r->refs, 1) != 1) return;
+    for (size_t i = 0; i < r->count; i++) free(r->jobs[i].dir);
+    free(r->jobs);
+    pthread_cond_destroy(&r->changed);
+    pthread_mutex_destroy(&r->lock);
+    free(r);
+}
+
+static void free_mounts(MountInfo *mounts, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(mounts[i].fsname);
+        free(mounts[i].dir);
+        free(mounts[i].type);
+        if (mounts[i].hung) round_release(mounts[i].hung);
+    }
+    free(mounts);
+}
+
+/**
+ * @brief 작업 스레드: 남은 마운트를 하나씩 가져와 statvfs를 부릅니다.
+ *
+ * 제한 시간을 넘겨 main이 이미 STAT_TIMEDOUT으로 정한 작업에서 돌아오면, main이 대신할
+ * 스레드를 띄웠으므로 이 스레드는 더 가져가지 않고 끝난다. (스레드 수가 늘지 않게)
+ */
+static void *stat_worker(void *arg) {
+    StatRound *r = arg;
+    pthread_mutex_lock(&r->lock);
+    while (r->next < r->count) {
+        StatJob *job = &r->jobs[r->next++];
+        if (job->state != STAT_PENDING) continue; // 아직 멈춰 있는 마운트 (statvfs_all 참고)
+        job->state = STAT_RUNNING;
+        clock_gettime(CLOCK_MONOTONIC, &job->started);
+        // main이 이 작업의 마감 시각을 알고 기다리도록 깨운다. (처음 띄운 스레드가
+        // 모두 statvfs에서 멈추면 끝나는 작업이 없어 main이 영영 깨지 않는다)
+        pthread_cond_signal(&r->changed);
+        pthread_mutex_unlock(&r->lock);
+
+        // 시험용: 응답하지 않는 네트워크 마운트 흉내
+        if (r->slow_mount && strcmp(job->dir, r->slow_mount) == 0) {
+            sleep(SLOW_MOUNT_SECONDS);
+        }
+        struct statvfs st;
+        int ret = statvfs(job->dir, &st);
+
+        pthread_mutex_lock(&r->lock);
+        if (job->state != STAT_RUNNING) {
+            job->returned = 1;
+            break;
+        }
+        job->st = st;
+        job->state = (ret == 0) ? STAT_OK : STAT_FAILED;
+        r->finished++;
+        pthread_cond_signal(&r->changed);
+    }
+    pthread_mutex_unlock(&r->lock);
+    round_release(r);
+    return NULL;
+}
+
+static void spawn_stat_worker(StatRound *r) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    // 멈춘 스레드는 기다리지(join) 않으므로 분리해 둔다.
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    atomic_fetch_add(&r->refs, 1);
+    pthread_t tid;
+    if (pthread_create(&tid, &attr, stat_worker, r) != 0) {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+/**
+ * @brief 여러 마운트의 statvfs를 작업 스레드 풀에서 동시에 부릅니다.
+ * @param mounts 마운트 배열
+ * @param results statvfs 결과 (count개)
+ * @param status 마운트별 STAT_OK, STAT_FAILED, STAT_TIMEDOUT (count개)
+ *
+ * 각 마운트의 제한 시간은 스레드가 그 마운트를 시작한 때부터 잽니다. 넘기면 그 마운트는
+ * STAT_TIMEDOUT으로 정하고 새 스레드를 띄워, 멈춘 마운트 하나가 나머지를 막지 않게 합니다.
+ * 그 마운트의 mounts[i].hung에 작업 묶음을 남겨, 다음 호출(--watch)에서는 돌아올 때까지 건너뜁니다.
+ */
+static void statvfs_all(MountInfo *mounts, size_t count, struct statvfs *results, int *status,
+                        const DfOptions *opts) {
+    if (count == 0) return;
+
+    StatRound *r = calloc(1, sizeof(StatRound));
+    if (!r || !(r->jobs = calloc(count, sizeof(StatJob)))) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    r->count = count;
+    r->slow_mount = opts->slow_mount;
+    for (size_t i = 0; i < count; i++) {
+        // 스레드가 main보다 오래 살 수 있으므로 경로도 묶음이 따로 갖는다.
+        if (!(r->jobs[i].dir = strdup(mounts[i].dir))) {
+            perror("strdup");
+            exit(EXIT_FAILURE);
+        }
+    }
+    atomic_init(&r->refs, 1);
+
+    // 지난번에 멈춘 statvfs가 아직 안 돌아온 마운트는 부르지 않고 바로 시간 초과로 둔다.
+    for (size_t i = 0; i < count; i++) {
+        StatRound *old = mounts[i].hung;
+        if (!old) continue;
+        pthread_mutex_lock(&old->lock);
+        int still_hung = !old->jobs[mounts[i].hung_index].returned;
+        pthread_mutex_unlock(&old->lock);
+        if (still_hung) {
+            r->jobs[i].state = STAT_TIMEDOUT;
+            r->finished++;
+        } else {
+            round_release(old);
+            mounts[i].hung = NULL;
+        }
+    }
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&r->changed, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    long timeout_ns = (long)(opts->timeout * 1e9);
+    size_t nworkers = (size_t)opts->jobs < count ? (size_t)opts->jobs : count;
+
+    pthread_mutex_lock(&r->lock);
+    for (size_t i = 0; i < nworkers; i++) spawn_stat_worker(r);
+
+    while (r->finished < count) {
+        // 실행 중인 작업 가운데 가장 이른 마감 시각까지 기다린다.
+        struct timespec earliest = {0, 0};
+        int have_deadline = 0;
+        if (timeout_ns > 0) {
+            for (size_t i = 0; i < count; i++) {
+                if (r->jobs[i].state != STAT_RUNNING) continue;
+                struct timespec d = r->jobs[i].started;
+                d.tv_sec += timeout_ns / 1000000000L;
+                d.tv_nsec += timeout_ns % 1000000000L;
+                if (d.tv_nsec >= 1000000000L) {
+                    d.tv_sec++;
+                    d.tv_nsec -= 1000000000L;
+                }
+                if (!have_deadline || d.tv_sec < earliest.tv_sec ||
+                    (d.tv_sec == earliest.tv_sec && d.tv_nsec < earliest.tv_nsec)) {
+                    earliest = d;
+                    have_deadline = 1;
+                }
+            }
+        }
+        if (!have_deadline) {
+            pthread_cond_wait(&r->changed, &r->lock);
             continue;
         }
+        pthread_cond_timedwait(&r->changed, &r->lock, &earliest);
 
-        // --- 용량 계산 ---
-        // f_frsize: 기본 블록 크기
-        // f_blocks: 전체 블록 수
-        // f_bfree: 남은 블록 수 (전체)
-        // f_bavail: 남은 블록 수 (root가 아닌 일반 사용자가 사용 가능한)
-        uint64_t block_size = fs_stats.f_frsize;
-        uint64_t total_size = fs_stats.f_blocks * block_size;
-        uint64_t free_size = fs_stats.f_bfree * block_size;
-        uint64_t avail_size = fs_stats.f_bavail * block_size;
-        uint64_t used_size = total_size - free_size;
-        int use_percent = (total_size == 0) ? 0 : (int)(((double)used_size / (used_size + avail_size)) * 100 + 0.5);
+        // 마감을 넘긴 작업은 포기하고, 그 스레드 대신 남은 작업을 맡을 스레드를 띄운다.
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long now_ns = (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+        for (size_t i = 0; i < count; i++) {
+            StatJob *job = &r->jobs[i];
+            if (job->state != STAT_RUNNING) continue;
+            long long start_ns = (long long)job->started.tv_sec * 1000000000LL + job->started.tv_nsec;
+            if (now_ns - start_ns < timeout_ns) continue;
+            job->state = STAT_TIMEDOUT;
+            r->finished++;
+            if (r->next < count) spawn_stat_worker(r);
+        }
+    }
 
-        // --- 최종 출력 ---
-        printf("%-20s", mount_entry->mnt_fsname);
-        
-        if (show_type) {
-            printf(" %-10s", mount_entry->mnt_type);
+    for (size_t i = 0; i < count; i++) {
+        status[i] = r->jobs[i].state;
+        if (status[i] == STAT_OK) results[i] = r->jobs[i].st;
+        if (status[i] == STAT_TIMEDOUT && !mounts[i].hung) {
+            atomic_fetch_add(&r->refs, 1);
+            mounts[i].hung = r;
+            mounts[i].hung_index = i;
         }
+    }
+    pthread_mutex_unlock(&r->lock);
+    round_release(r);
+}
+
+// --- 출력 ---
 
-        if (human_readable) { // -h 옵션: K, M, G 단위로 출력
-            print_human_readable(total_size);
-            print_human_readable(used_size);
-            print_human_readable(avail_size);
-        } else { // 기본: 1K 블록 단위로 출력 (df 기본 동작)
-            printf(" %10lu", total_size / 1024);
-            printf(" %10lu", used_size / 1024);
-            printf(" %10lu", avail_size / 1024);
+static void print_header(const DfOptions *opts) {
+    printf("%-20s", "Filesystem");
+    if (opts->show_type) printf(" %-10s", "Type");
+    printf(" %10s %10s %10s %5s", "Size", "Used", "Avail", "Use%");
+    if (opts->watch_interval > 0) printf(" %9s %9s %8s", "Used/s", "Inodes/s", "Full in");
+    printf(" %-s\n", "Mounted on");
+}
+
+/**
+ * @brief 마운트 한 줄의 앞부분(장치 이름부터 Use%까지)을 출력합니다.
+ * @param st statvfs 결과, NULL이면 제한 시간 안에 답이 없었던 마운트로 보고 숫자 대신 "?"를 찍는다.
+ */
+static void print_usage(const MountInfo *m, const struct statvfs *st, const DfOptions *opts) {
+    printf("%-20s", m->fsname);
+    if (opts->show_type) {
+        printf(" %-10s", m->type);
+    }
+
+    if (!st) {
+        if (opts->human_readable) printf("%6s%6s%6s", "?", "?", "?");
+        else printf(" %10s %10s %10s", "?", "?", "?");
+        printf(" %5s", "?");
+        return;
+    }
+
+    // --- 용량 계산 ---
+    // f_frsize: 기본 블록 크기
+    // f_blocks: 전체 블록 수
+    // f_bfree: 남은 블록 수 (전체)
+    // f_bavail: 남은 블록 수 (root가 아닌 일반 사용자가 사용 가능한)
+    uint64_t block_size = st->f_frsize;
+    uint64_t total_size = st->f_blocks * block_size;
+    uint64_t free_size = st->f_bfree * block_size;
+    uint64_t avail_size = st->f_bavail * block_size;
+    uint64_t used_size = total_size - free_size;
+    int use_percent = (total_size == 0) ? 0 : (int)(((double)used_size / (used_size + avail_size)) * 100 + 0.5);
+
+    if (opts->human_readable) { // -h 옵션: K, M, G 단위로 출력
+        print_human_readable(total_size);
+        print_human_readable(used_size);
+        print_human_readable(avail_size);
+    } else { // 기본: 1K 블록 단위로 출력 (df 기본 동작)
+        printf(" %10lu", total_size / 1024);
+        printf(" %10lu", used_size / 1024);
+        printf(" %10lu", avail_size / 1024);
+    }
+
+    printf(" %4d%%", use_percent);
+}
+
+static void print_mount(const MountInfo *m, const struct statvfs *st, const DfOptions *opts) {
+    print_usage(m, st, opts);
+    printf(" %-s\n", m->dir);
+}
+
+// --- --watch ---
+
+/**
+ * @brief 초당 바이트 변화량을 "+1.5M/s" 같은 글자로 만듭니다.
+ */
+static void format_byte_rate(double rate, char *out, size_t size) {
+    const char *units[] = {"B", "K", "M", "G", "T", "P"};
+    double v = rate < 0 ? -rate : rate;
+    int i = 0;
+    while (v >= 1024 && i < (int)(sizeof(units) / sizeof(char *)) - 1) {
+        v /= 1024;
+        i++;
+    }
+    if (v < 0.05) snprintf(out, size, "0/s");
+    else snprintf(out, size, "%c%.1f%s/s", rate < 0 ? '-' : '+', v, units[i]);
+}
+
+/**
+ * @brief 가득 찰 때까지 남은 시간을 "3d04h", "5h12m", "12m", "40s"로 만듭니다.
+ * @param seconds 남은 초, 음수이면(줄고 있거나 그대로) "-"
+ */
+static void format_time_to_full(double seconds, char *out, size_t size) {
+    if (seconds < 0 || seconds >= 1000.0 * 86400) {
+        snprintf(out, size, "-");
+        return;
+    }
+    long s = (long)seconds;
+    if (s >= 86400) snprintf(out, size, "%ldd%02ldh", s / 86400, s % 86400 / 3600);
+    else if (s >= 3600) snprintf(out, size, "%ldh%02ldm", s / 3600, s % 3600 / 60);
+    else if (s >= 60) snprintf(out, size, "%ldm", s / 60);
+    else snprintf(out, size, "%lds", s);
+}
+
+/**
+ * @brief 새 표본으로 증가 속도와 그 평활 값을 갱신합니다.
+ * @param now 표본 시각 (CLOCK_MONOTONIC, 초)
+ *
+ * 남은 시간은 구간 하나의 속도로 추정하면 큰 파일 하나 쓰고 지울 때마다 크게 출렁이므로,
+ * 속도를 지수 평활(s = a*rate + (1-a)*s)한 값으로 나눕니다.
+ */
+static void update_sample(MountInfo *m, const struct statvfs *st, double now) {
+    uint64_t used = (uint64_t)(st->f_blocks - st->f_bfree) * st->f_frsize;
+    uint64_t iused = st->f_files >= st->f_ffree ? st->f_files - st->f_ffree : 0;
+    if (m->sampled && now > m->sample_time) {
+        double dt = now - m->sample_time;
+        m->byte_rate = ((double)used - (double)m->used_bytes) / dt;
+        m->inode_rate = ((double)iused - (double)m->used_inodes) / dt;
+        m->smoothed_rate = m->have_rate
+            ? WATCH_EWMA_ALPHA * m->byte_rate + (1 - WATCH_EWMA_ALPHA) * m->smoothed_rate
+            : m->byte_rate;
+        m->have_rate = 1;
+    }
+    m->sampled = 1;
+    m->sample_time = now;
+    m->used_bytes = used;
+    m->used_inodes = iused;
+}
+
+static void print_watch_row(const MountInfo *m, const struct statvfs *st, const DfOptions *opts) {
+    char bytes[32], inodes[32], full[32];
+    if (!st || !m->have_rate) {
+        const char *mark = st ? "-" : "?";
+        snprintf(bytes, sizeof(bytes), "%s", mark);
+        snprintf(inodes, sizeof(inodes), "%s", mark);
+        snprintf(full, sizeof(full), "%s", mark);
+    } else {
+        format_byte_rate(m->byte_rate, bytes, sizeof(bytes));
+        snprintf(inodes, sizeof(inodes), "%+.0f/s", m->inode_rate);
+        double avail = (double)st->f_bavail * st->f_frsize;
+        format_time_to_full(m->smoothed_rate > 0 ? avail / m->smoothed_rate : -1, full, sizeof(full));
+    }
+    print_usage(m, st, opts);
+    printf(" %9s %9s %8s %-s\n", bytes, inodes, full, m->dir);
+}
+
+/**
+ * @brief 다시 읽은 마운트 목록에 이전 목록의 표본을 이어 붙입니다.
+ *
+ * 장치 이름과 마운트 지점이 같으면 같은 마운트로 봅니다. 새로 생긴 마운트는 표본 없이 시작합니다.
+ */
+static void carry_over_samples(MountInfo *old, size_t old_count, MountInfo *mounts, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < old_count; j++) {
+            if (!old[j].fsname || strcmp(old[j].dir, mounts[i].dir) != 0 ||
+                strcmp(old[j].fsname, mounts[i].fsname) != 0) {
+                continue;
+            }
+            // 이름 문자열은 새 항목 것을 쓰고 나머지 상태만 옮긴다. (hung 참조도 넘긴다)
+            MountInfo keep = mounts[i];
+            mounts[i] = old[j];
+            mounts[i].fsname = keep.fsname;
+            mounts[i].dir = keep.dir;
+            mounts[i].type = keep.type;
+            old[j].hung = NULL;
+            break;
         }
+    }
+}
 
-        printf(" %4d%% %-s\n", use_percent, mount_entry->mnt_dir);
+/**
+ * @brief --watch: 일정 간격으로 모든 마운트의 사용량과 증가 속도를 출력합니다.
+ *
+ * 마운트 목록은 바뀔 때만 다시 읽습니다. /proc/self/mountinfo는 마운트 테이블이 바뀌면
+ * poll에 POLLPRI(와 POLLERR)를 알려 주므로, 틱 사이에 그 fd를 poll하며 잠들어 있다가
+ * 알림이 오면 다음 틱에서 한 번만 다시 읽습니다. (틱마다 /proc/mounts를 파싱하지 않음)
+ */
+static int watch_mounts(const DfOptions *opts) {
+    int mountinfo_fd = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    if (mountinfo_fd == -1) {
+        perror("open /proc/self/mountinfo");
+        exit(EXIT_FAILURE);
     }
 
-    // 열었던 마운트 테이블 파일을 닫는다.
-    endmntent(mount_table);
-    return 0;
+    size_t count;
+    MountInfo *mounts = read_mounts(opts, &count);
+    struct statvfs *results = NULL;
+    int *status = NULL;
+    size_t results_cap = 0;
+    int changed = 0;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    long interval_ns = (long)(opts->watch_interval * 1e9);
+
+    for (int frame = 0; opts->iterations == 0 || frame < opts->iterations; frame++) {
+        if (changed) {
+            size_t new_count;
+            MountInfo *fresh = read_mounts(opts, &new_count);
+            carry_over_samples(mounts, count, fresh, new_count);
+            free_mounts(mounts, count);
+            mounts = fresh;
+            count = new_count;
+            changed = 0;
+        }
+        if (count > results_cap) {
+            results_cap = count;
+            results = realloc(results, results_cap * sizeof(struct statvfs));
+            status = realloc(status, results_cap * sizeof(int));
+            if (!results || !status) {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        statvfs_all(mounts, count, results, status, opts);
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        double now = ts.tv_sec + ts.tv_nsec / 1e9;
+
+        time_t wall = time(NULL);
+        char clock_buf[16];
+        strftime(clock_buf, sizeof(clock_buf), "%H:%M:%S", localtime(&wall));
+        printf("%s# %s\n", frame ? "\n" : "", clock_buf);
+        print_header(opts);
+        for (size_t i = 0; i < count; i++) {
+            if (status[i] == STAT_FAILED) continue;
+            if (status[i] == STAT_OK) update_sample(&mounts[i], &results[i], now);
+            print_watch_row(&mounts[i], status[i] == STAT_OK ? &results[i] : NULL, opts);
+        }
+        fflush(stdout);
+        if (opts->iterations != 0 && frame + 1 >= opts->iterations) break;
+
+        // 다음 틱까지 마운트 테이블 변경을 기다린다. (변경은 표시만 해 두고 틱은 그대로)
+        next.tv_sec += interval_ns / 1000000000L;
+        next.tv_nsec += interval_ns % 1000000000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        for (;;) {
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            long long left_ms = ((long long)(next.tv_sec - ts.tv_sec) * 1000000000LL +
+                                 (next.tv_nsec - ts.tv_nsec)) / 1000000;
+            if (left_ms <= 0) {
+                // statvfs가 오래 걸려 밀렸으면 밀린 틱을 몰아서 찍지 않고 지금부터 다시 잰다.
+                if (left_ms < -(long long)(interval_ns / 1000000)) next = ts;
+                break;
+            }
+            struct pollfd pfd = { mountinfo_fd, POLLPRI, 0 };
+            int ret = poll(&pfd, 1, (int)left_ms);
+            if (ret == -1) {
+                if (errno == EINTR) continue;
+                perror("poll /proc/self/mountinfo");
+                exit(EXIT_FAILURE);
+            }
+            if (ret > 0 && (pfd.revents & (POLLPRI | POLLERR))) changed = 1;
+        }
+    }
+
+    free(results);
+    free(status);
+    free_mounts(mounts, count);
+    close(mountinfo_fd);
+    return EXIT_SUCCESS;
+}
+
+// 메인 함수
+int main(int argc, char *argv[]) {
+    DfOptions opts = {0};
+    opts.jobs = DF_DEFAULT_JOBS;
+    opts.timeout = DF_DEFAULT_TIMEOUT;
+
+    static const struct option long_opts[] = {
+        {"timeout",    required_argument, NULL, 't'},
+        {"slow-mount", required_argument, NULL, 'S'},
+        {"watch",      required_argument, NULL, 'w'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    // getopt_long을 사용하여 명령줄 옵션을 파싱 ('t', 'S', 'w'는 긴 옵션 전용)
+    while ((opt = getopt_long(argc, argv, "hTaj:n:", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'h': opts.human_readable = 1; break;
+            case 'T': opts.show_type = 1;      break;
+            case 'a': opts.show_all = 1;       break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                if (opts.jobs < 1) {
+                    fprintf(stderr, "df: invalid number of jobs: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'n':
+                opts.iterations = atoi(optarg);
+                if (opts.iterations < 0) {
+                    fprintf(stderr, "df: invalid count: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 't': {
+                char *end;
+                opts.timeout = strtod(optarg, &end);
+                if (*end != '\0' || opts.timeout < 0) {
+                    fprintf(stderr, "df: invalid timeout: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'w': {
+                char *end;
+                opts.watch_interval = strtod(optarg, &end);
+                if (*end != '\0' || opts.watch_interval <= 0) {
+                    fprintf(stderr, "df: invalid interval: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'S': opts.slow_mount = optarg; break;
+            default:
+                fprintf(stderr, "사용법: %s [-hTa] [-j N] [--timeout SECS] [--slow-mount DIR]\n"
+                                "       %s [-hTa] --watch SECS [-n COUNT]\n",
+                        argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (opts.watch_interval > 0) {
+        return watch_mounts(&opts);
+    }
+
+    size_t count;
+    MountInfo *mounts = read_mounts(&opts, &count);
+    struct statvfs *results = calloc(count ? count : 1, sizeof(struct statvfs));
+    int *status = calloc(count ? count : 1, sizeof(int));
+    if (!results || !status) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    statvfs_all(mounts, count, results, status, &opts);
+
+    // 결과는 마운트 테이블 순서대로 출력한다.
+    int exit_status = EXIT_SUCCESS;
+    print_header(&opts);
+    for (size_t i = 0; i < count; i++) {
+        if (status[i] == STAT_FAILED) {
+            // 실패 시 해당 항목은 건너뛴다 (예: 접근 권한 없는 경우)
+            continue;
+        }
+        if (status[i] == STAT_TIMEDOUT) {
+            fprintf(stderr, "df: %s: statvfs timed out after %gs\n", mounts[i].dir, opts.timeout);
+            exit_status = EXIT_FAILURE;
+            print_mount(&mounts[i], NULL, &opts);
+            continue;
+        }
+        print_mount(&mounts[i], &results[i], &opts);
+    }
+
+    free(results);
+    free(status);
+    free_mounts(mounts, count);
+    // 멈춘 작업 스레드가 남아 있어도 exit로 프로세스와 함께 끝난다.
+    return exit_status;
 }
\ No newline at end of file
@@ -0,0 +1,499 @@
+#define _GNU_SOURCE     // for statx, O_DIRECTORY
+#include <stdio.h>
+#include <stdlib.h>     // for exit, strtol
+#include <string.h>     // for strlen, strerror
+#include <unistd.h>     // for sysconf, close
+#include <fcntl.h>      // for openat
+#include <errno.h>      // for errno
+#include <getopt.h>     // for getopt_long (--max-depth)
+#include <stdint.h>     // for uint64_t
+#include <sys/stat.h>   // for statx
+#include <pthread.h>    // for 병렬 탐색
+#include <stdatomic.h>  // for 하위 디렉터리 완료 카운트, 블록 합계
+#include "c_walk.h"     // getdents64 읽기, 작업 덱 등 c_ls와 공유하는 탐색 부품
+
+// 프로그램 옵션을 담는 구조체
+typedef struct {
+    int human_readable; // -h: K, M, G 단위로 표시
+    int max_depth;      // --max-depth N, -s(=0): 이 깊이까지의 디렉터리만 출력 (-1이면 제한 없음)
+    int one_fs;         // -x: 다른 파일 시스템에 있는 디렉터리는 건너뜀
+    int jobs;           // -j N: 작업 스레드 수
+} DuOptions;
+
+// --- 하드 링크 중복 제거 ---
+// 링크 수가 2 이상인 파일만 (dev, ino)를 기록해 두고, 처음 본 경우에만 크기를 더한다.
+// 전역 잠금 하나 대신 해시값으로 고른 샤드마다 잠금을 두어 스레드끼리 거의 부딪히지 않게 한다.
+
+#define INODE_SHARDS 64
+
+typedef struct {
+    uint64_t dev, ino;  // ino가 0이면 빈 슬롯 (리눅스에서 0번 inode는 쓰이지 않음)
+} InodeKey;
+
+typedef struct {
+    pthread_mutex_t lock;
+    InodeKey *slots;    // 오픈 어드레싱 해시 테이블
+    size_t count, cap;
+} InodeShard;
+
+static InodeShard g_inodes[INODE_SHARDS];
+
+static uint64_t hash_inode(uint64_t dev, uint64_t ino) {
+    uint64_t h = ino * 0x9E3779B97F4A7C15ULL ^ dev * 0xC2B2AE3D27D4EB4FULL;
+    return h ^ (h >> 29);
+}
+
+// 처음 보는 inode면 기록하고 1을, 이미 센 inode면 0을 돌려준다.
+static int inode_set_insert(uint64_t dev, uint64_t ino) {
+    uint64_t h = hash_inode(dev, ino);
+    InodeShard *shard = &g_inodes[h % INODE_SHARDS];
+    h /= INODE_SHARDS;
+
+    pthread_mutex_lock(&shard->lock);
+    // 절반 이상 차면 2배로 늘려 다시 넣는다.
+    if ((shard->count + 1) * 2 > shard->cap) {
+        size_t new_cap = shard->cap ? shard->cap * 2 : 256;
+        InodeKey *slots = calloc(new_cap, sizeof(InodeKey));
+        if (!slots) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < shard->cap; i++) {
+            InodeKey *k = &shard->slots[i];
+            if (k->ino == 0) continue;
+            size_t j = (hash_inode(k->dev, k->ino) / INODE_SHARDS) & (new_cap - 1);
+            while (slots[j].ino != 0) j = (j + 1) & (new_cap - 1);
+            slots[j] = *k;
+        }
+        free(shard->slots);
+        shard->slots = slots;
+        shard->cap = new_cap;
+    }
+
+    size_t j = h & (shard->cap - 1);
+    int inserted = 0;
+    for (;;) {
+        InodeKey *k = &shard->slots[j];
+        if (k->ino == 0) {
+            k->dev = dev;
+            k->ino = ino;
+            shard->count++;
+            inserted = 1;
+            break;
+        }
+        if (k->dev == dev && k->ino == ino) break;
+        j = (j + 1) & (shard->cap - 1);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return inserted;
+}
+
+// --- 디렉터리 작업 ---
+// 디렉터리 하나가 작업 하나다. 작업 스레드는 직속 파일들의 블록 수를 지역 변수에 모으고,
+// 하위 디렉터리는 자식 작업으로 만들어 자신의 덱에 넣는다.
+// 디렉터리는 자신과 모든 하위 디렉터리가 끝나면(pending이 0이 되면) 합계를 부모에게 더한다.
+// 이렇게 아래에서 위로 합치므로 합계를 위한 전역 잠금이 필요 없다.
+
+typedef struct DuNode {
+    struct DuNode *parent;
+    char *name;                 // 부모 기준 이름 (루트는 명령줄 인자)
+    SharedFd *parent_fd;        // openat 기준 fd (루트는 NULL)
+    int fd;                     // 루트에서만 미리 열린 fd
+    int depth;
+    uint64_t own_blocks;        // 디렉터리 자신 + 직속 파일들의 512바이트 블록 수
+    atomic_uint_fast64_t child_blocks; // 끝난 하위 디렉터리들의 합계
+    uint64_t total_blocks;      // 완료 후: own_blocks + child_blocks
+    atomic_int pending;         // 끝나지 않은 하위 디렉터리 수 + 1(자기 자신)
+    struct DuNode **children;   // 출력할 하위 디렉터리 (max_depth 이내만)
+    size_t nchildren;
+} DuNode;
+
+typedef struct {
+    const DuOptions *opts;
+    uint64_t root_dev;          // -x 비교용
+    WorkDeque *deques;          // 작업 스레드마다 하나
+    int ndeques;
+    pthread_mutex_t lock;       // 아래 조건 변수용
+    pthread_cond_t changed;     // 작업 추가/루트 완료 시 알림
+    unsigned long epoch;        // 알림 누락을 막기 위한 변경 카운터
+    int done;                   // 루트 디렉터리의 합계가 끝났는지
+    atomic_int exit_status;     // 하나라도 읽지 못한 항목이 있으면 EXIT_FAILURE
+} DuPool;
+
+typedef struct {
+    DuPool *pool;
+    int index;
+} DuWorkerArg;
+
+static void pool_notify(DuPool *pool, int root_done) {
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch++;
+    if (root_done) pool->done = 1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static int keeps_for_output(const DuPool *pool, const DuNode *node) {
+    return pool->opts->max_depth < 0 || node->depth <= pool->opts->max_depth;
+}
+
+static void free_node(DuNode *node) {
+    free(node->name);
+    free(node->children);
+    free(node);
+}
+
+// 오류 메시지용 경로를 만든다. 아직 끝나지 않은 작업의 조상은 모두 살아 있다.
+static void node_path(const DuNode *node, char *buf, size_t size) {
+    if (!node->parent) {
+        snprintf(buf, size, "%s", node->name);
+        return;
+    }
+    node_path(node->parent, buf, size);
+    size_t len = strlen(buf);
+    snprintf(buf + len, size - len, "/%s", node->name);
+}
+
+// 작업 하나의 몫이 끝났음을 알린다. 마지막으로 끝난 것이면 합계를 확정하고 부모로 올라간다.
+static void node_release(DuPool *pool, DuNode *node) {
+    while (atomic_fetch_sub(&node->pending, 1) == 1) {
+        node->total_blocks = node->own_blocks + atomic_load(&node->child_blocks);
+        DuNode *parent = node->parent;
+        if (!parent) {
+            pool_notify(pool, 1);
+            return;
+        }
+        atomic_fetch_add(&parent->child_blocks, node->total_blocks);
+        // 출력하지 않을 깊이의 디렉터리는 합계를 넘긴 뒤 바로 해제한다.
+        if (!keeps_for_output(pool, node)) {
+            free_node(node);
+        }
+        node = parent;
+    }
+}
+
+// 디렉터리 하나를 처리한다: 열기, 항목별 statx, 하위 디렉터리 작업 등록
+static void run_node(DuPool *pool, DuNode *node, int deque_index, char *dirent_buf) {
+    const DuOptions *opts = pool->opts;
+    int dirfd = node->fd;
+    char path[4096];
+
+    if (node->parent_fd) {
+        dirfd = openat(node->parent_fd->fd, node->name,
+                       O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        shared_fd_unref(node->parent_fd);
+        node->parent_fd = NULL;
+    }
+    if (dirfd == -1) {
+        node_path(node, path, sizeof(path));
+        fprintf(stderr, "du: cannot read directory '%s': %s\n", path, strerror(errno));
+        pool->exit_status = EXIT_FAILURE;
+        node_release(pool, node);
+        return;
+    }
+
+    uint64_t blocks = 0;        // 이 스레드가 모으는 직속 파일들의 부분 합
+    DuNode **subdirs = NULL;
+    size_t nsub = 0, sub_cap = 0;
+
+    long nread;
+    while ((nread = read_dirents(dirfd, dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *)(dirent_buf + off);
+            off += entry->d_reclen;
+            if (is_dot_or_dotdot(entry->d_name)) continue;
+
+            struct statx stx;
+            if (statx(dirfd, entry->d_name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+                      STATX_TYPE | STATX_NLINK | STATX_INO | STATX_BLOCKS, &stx) == -1) {
+                node_path(node, path, sizeof(path));
+                fprintf(stderr, "du: cannot access '%s/%s': %s\n", path, entry->d_name, strerror(errno));
+                pool->exit_status = EXIT_FAILURE;
+                continue;
+            }
+            uint64_t dev = ((uint64_t)stx.stx_dev_major << 32) | stx.stx_dev_minor;
+
+            if (S_ISDIR(stx.stx_mode)) {
+                if (opts->one_fs && dev != pool->root_dev) continue;
+
+                DuNode *child = calloc(1, sizeof(DuNode));
+                if (!child || !(child->name = strdup(entry->d_name))) {
+                    perror("malloc");
+                    exit(EXIT_FAILURE);
+                }
+                child->parent = node;
+                child->fd = -1;
+                child->depth = node->depth + 1;
+                child->own_blocks = stx.stx_blocks;
+                atomic_init(&child->child_blocks, 0);
+                atomic_init(&child->pending, 1);
+                subdirs = grow_array(subdirs, &sub_cap, nsub + 1, sizeof(DuNode *));
+                subdirs[nsub++] = child;
+            } else if (stx.stx_nlink < 2 || inode_set_insert(dev, stx.stx_ino)) {
+                blocks += stx.stx_blocks;
+            }
+        }
+    }
+    if (nread == -1) {
+        node_path(node, path, sizeof(path));
+        fprintf(stderr, "du: cannot read directory '%s': %s\n", path, strerror(errno));
+        pool->exit_status = EXIT_FAILURE;
+    }
+    node->own_blocks += blocks;
+
+    if (nsub > 0) {
+        SharedFd *sfd = shared_fd_new(dirfd, (int)nsub);
+        // 출력할 하위 디렉터리는 읽은 순서대로 기억해 둔다. (작업을 넣기 전에 해야 함)
+        if (keeps_for_output(pool, subdirs[0])) {
+            node->children = malloc(nsub * sizeof(DuNode *));
+            if (!node->children) {
+                perror("malloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (size_t i = 0; i < nsub; i++) {
+            subdirs[i]->parent_fd = sfd;
+            if (node->children) {
+                node->children[node->nchildren++] = subdirs[i];
+            }
+        }
+        atomic_fetch_add(&node->pending, (int)nsub);
+        for (size_t i = nsub; i-- > 0; ) {
+            deque_push(&pool->deques[deque_index], subdirs[i]);
+        }
+        pool_notify(pool, 0);
+    } else {
+        close(dirfd);
+    }
+    free(subdirs);
+
+    node_release(pool, node);
+}
+
+static void *worker_main(void *p) {
+    DuWorkerArg *arg = p;
+    DuPool *pool = arg->pool;
+    char *dirent_buf = malloc(DIRENT_BUF_SIZE); // 스레드마다 자신의 getdents64 버퍼를 쓴다.
+    if (!dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        unsigned long seen = pool->epoch;
+        int done = pool->done;
+        pthread_mutex_unlock(&pool->lock);
+        if (done) break;
+
+        // 자신의 덱에서 먼저 꺼내고, 비어 있으면 다른 덱에서 훔친다.
+        DuNode *node = deque_pop(&pool->deques[arg->index], 0);
+        for (int i = 1; !node && i < pool->ndeques; i++) {
+            node = deque_pop(&pool->deques[(arg->index + i) % pool->ndeques], 1);
+        }
+        if (node) {
+            run_node(pool, node, arg->index, dirent_buf);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->epoch == seen && !pool->done) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    free(dirent_buf);
+    return NULL;
+}
+
+/**
+ * @brief 크기를 du 형식으로 출력합니다. 기본은 1K 블록 단위, -h면 K/M/G 단위를 붙입니다.
+ * @param blocks 512바이트 블록 수
+ *
+ * -h는 GNU du처럼 올림합니다. (10 미만은 ceil(size*10)/10, 그 외는 ceil(size))
+ * 부동소수점 없이 정수 나눗셈으로 계산하므로 -lm이 필요 없습니다.
+ */
+void print_size(uint64_t blocks, int human_readable) {
+    uint64_t bytes = blocks * 512;
+    if (!human_readable) {
+        printf("%lu", (unsigned long)((bytes + 1023) / 1024));
+        return;
+    }
+    const char *units = "BKMGTPE";
+    int i = 0;
+    uint64_t unit = 1;
+    while (bytes / unit >= 1024 && units[i + 1]) {
+        unit *= 1024;
+        i++;
+    }
+    if (i == 0) {
+        printf("%lu", (unsigned long)bytes);
+        return;
+    }
+    uint64_t q = bytes / unit, r = bytes % unit;
+    uint64_t tenths = q * 10 + (r * 10 + unit - 1) / unit;
+    if (tenths < 100) {
+        printf("%lu.%lu%c", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10), units[i]);
+        return;
+    }
+    uint64_t whole = q + (r != 0);
+    if (whole >= 1024 && units[i + 1]) {
+        printf("1.0%c", units[i + 1]); // 올림으로 1024가 되면 다음 단위 (1023.5K -> 1.0M)
+    } else {
+        printf("%lu%c", (unsigned long)whole, units[i]);
+    }
+}
+
+// 하위 디렉터리를 먼저, 자신을 나중에 출력한다. (du와 같은 후위 순서)
+static void print_tree(DuNode *node, char **path, size_t *path_cap, size_t path_len,
+                       const DuOptions *opts) {
+    for (size_t i = 0; i < node->nchildren; i++) {
+        DuNode *child = node->children[i];
+        size_t name_len = strlen(child->name);
+        *path = grow_array(*path, path_cap, path_len + name_len + 2, 1);
+        (*path)[path_len] = '/';
+        memcpy(*path + path_len + 1, child->name, name_len + 1);
+        print_tree(child, path, path_cap, path_len + 1 + name_len, opts);
+        (*path)[path_len] = '\0';
+    }
+    print_size(node->total_blocks, opts->human_readable);
+    printf("\t%s\n", path_len ? *path : "/"); // 경로가 비어 있는 것은 "/" 자체뿐이다.
+    if (node->parent) free_node(node);
+}
+
+/**
+ * @brief 경로 하나의 디스크 사용량을 병렬로 계산하고 출력합니다.
+ * @return 성공 시 EXIT_SUCCESS, 일부라도 읽지 못했으면 EXIT_FAILURE
+ */
+int disk_usage(const char *target, const DuOptions *opts) {
+    int fd = open(target, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct statx stx;
+    if (fd == -1) {
+        // 디렉터리가 아니면 그 파일 하나의 크기만 출력한다.
+        if (errno == ENOTDIR && statx(AT_FDCWD, target, AT_SYMLINK_NOFOLLOW, STATX_BLOCKS, &stx) == 0) {
+            print_size(stx.stx_blocks, opts->human_readable);
+            printf("\t%s\n", target);
+            return EXIT_SUCCESS;
+        }
+        fprintf(stderr, "du: cannot access '%s': %s\n", target, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (statx(fd, "", AT_EMPTY_PATH, STATX_BLOCKS, &stx) == -1) {
+        fprintf(stderr, "du: cannot access '%s': %s\n", target, strerror(errno));
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    DuPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.opts = opts;
+    pool.root_dev = ((uint64_t)stx.stx_dev_major << 32) | stx.stx_dev_minor;
+    pool.ndeques = opts->jobs;
+    pool.deques = calloc(pool.ndeques, sizeof(WorkDeque));
+    pthread_t *threads = calloc(opts->jobs, sizeof(pthread_t));
+    DuWorkerArg *args = calloc(opts->jobs, sizeof(DuWorkerArg));
+    DuNode *root = calloc(1, sizeof(DuNode));
+    if (!pool.deques || !threads || !args || !root || !(root->name = strdup(target))) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    for (int i = 0; i < pool.ndeques; i++) {
+        deque_init(&pool.deques[i]);
+    }
+
+    // 끝의 '/'는 떼어 "dir//sub" 같은 경로가 출력되지 않게 한다. ("/" 자체는 유지)
+    size_t len = strlen(root->name);
+    while (len > 1 && root->name[len - 1] == '/') root->name[--len] = '\0';
+    root->fd = fd;
+    root->own_blocks = stx.stx_blocks;
+    atomic_init(&root->child_blocks, 0);
+    atomic_init(&root->pending, 1);
+    deque_push(&pool.deques[0], root);
+
+    for (int i = 0; i < opts->jobs; i++) {
+        args[i].pool = &pool;
+        args[i].index = i;
+        if (pthread_create(&threads[i], NULL, worker_main, &args[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < opts->jobs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    char *path = NULL;
+    size_t path_cap = 0;
+    path = grow_array(path, &path_cap, len + 1, 1);
+    memcpy(path, root->name, len + 1);
+    if (strcmp(path, "/") == 0) path[0] = '\0'; // 하위 경로가 "//x"가 되지 않도록
+    print_tree(root, &path, &path_cap, strlen(path), opts);
+    free(path);
+    free_node(root);
+
+    for (int i = 0; i < pool.ndeques; i++) {
+        deque_destroy(&pool.deques[i]);
+    }
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.deques);
+    free(threads);
+    free(args);
+    return atomic_load(&pool.exit_status);
+}
+
+int main(int argc, char *argv[]) {
+    DuOptions opts = {0};
+    opts.max_depth = -1;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    opts.jobs = ncpu > 0 ? (int)ncpu : 1;
+
+    static const struct option long_opts[] = {
+        {"max-depth", required_argument, NULL, 'd'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "shxj:d:", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 's': opts.max_depth = 0; break;
+            case 'h': opts.human_readable = 1; break;
+            case 'x': opts.one_fs = 1; break;
+            case 'd':
+                opts.max_depth = atoi(optarg);
+                if (opts.max_depth < 0) {
+                    fprintf(stderr, "du: invalid maximum depth '%s'\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                if (opts.jobs < 1) {
+                    fprintf(stderr, "du: invalid number of jobs: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf(stderr, "사용법: %s [-shx] [-j N] [--max-depth N] [경로...]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int i = 0; i < INODE_SHARDS; i++) {
+        pthread_mutex_init(&g_inodes[i].lock, NULL);
+    }
+
+    // 인자가 없으면 현재 디렉터리를 대상으로 한다. 하드 링크는 인자 전체에 걸쳐 한 번만 센다.
+    int exit_status = EXIT_SUCCESS;
+    if (optind >= argc) {
+        exit_status = disk_usage(".", &opts);
+    }
+    for (int i = optind; i < argc; i++) {
+        if (disk_usage(argv[i], &opts) != EXIT_SUCCESS) {
+            exit_status = EXIT_FAILURE;
+        }
+    }
+    return exit_status;
+}
@@ -0,0 +1,484 @@
+#define _GNU_SOURCE     // for statx, FNM_CASEFOLD
+#include <stdio.h>
+#include <stdlib.h>     // for exit, strtoll, qsort
+#include <string.h>     // for strcmp, strrchr
+#include <unistd.h>     // for close
+#include <fcntl.h>      // for openat
+#include <errno.h>      // for errno
+#include <fnmatch.h>    // for fnmatch (-name, -iname)
+#include <stdint.h>     // for int64_t
+#include <time.h>       // for time
+#include <dirent.h>     // for DT_* 상수
+#include <sys/stat.h>   // for statx
+#include "c_walk.h"     // getdents64 읽기 등 c_ls와 공유하는 탐색 부품
+
+// --- 술어(predicate) 정의 ---
+// 명령줄의 식은 술어들의 AND로 보고, 평가 전에 "싸게 답할 수 있는 것부터" 순서를 바꾼다.
+//  1) -type: d_type만으로 답함 (d_type을 모르면 그때만 stat)
+//  2) -name/-iname: 이름 문자열만으로 답함
+//  3) -size/-mtime/-newer: 메타데이터가 필요함 -> 앞의 술어를 모두 통과한 항목만 stat
+// 모든 술어는 부작용이 없으므로 순서를 바꿔도 결과는 같다.
+
+typedef enum { PRED_TYPE, PRED_NAME, PRED_SIZE, PRED_MTIME, PRED_NEWER } PredKind;
+
+typedef struct {
+    PredKind kind;
+    int cost;               // 작을수록 먼저 평가 (stat이 필요한 술어는 항상 뒤)
+    unsigned int statx_mask; // 이 술어가 필요로 하는 메타데이터 (0이면 stat 불필요)
+    const char *pattern;    // -name/-iname 패턴
+    int fnm_flags;          // -iname이면 FNM_CASEFOLD
+    mode_t type;            // -type: S_IFREG 등
+    int cmp;                // -size/-mtime: -1(미만), 0(같음), 1(초과)
+    int64_t value;          // -size: 단위 개수, -mtime: 일 수
+    int64_t unit;           // -size: 단위 바이트 수
+    struct statx_timestamp ref; // -newer: 기준 파일의 mtime
+} Pred;
+
+typedef struct {
+    Pred *preds;            // 평가 순서대로 정렬된 술어 목록
+    size_t npreds;
+    unsigned int statx_mask; // 술어 전체가 필요로 하는 메타데이터 (한 번의 statx로 가져옴)
+    int max_depth;          // -maxdepth (-1이면 제한 없음)
+    char terminator;        // -print0이면 '\0', 아니면 '\n'
+    time_t now;             // -mtime 기준 시각
+} FindPlan;
+
+// 항목 하나를 평가하는 동안의 상태. stat은 필요해지는 순간 한 번만 한다.
+typedef struct {
+    int dirfd;              // 항목이 들어 있는 디렉터리 (루트는 AT_FDCWD)
+    const char *name;       // dirfd 기준 이름 (루트는 전체 경로)
+    const char *base;       // -name이 비교할 마지막 경로 구성요소
+    const char *path;       // 출력과 오류 메시지에 쓰는 전체 경로
+    mode_t type;            // d_type으로 알게 된 종류 (모르면 0)
+    int have_stat;          // 1: 읽음, -1: 실패 (오류는 이미 알림)
+    struct statx stx;
+} Candidate;
+
+static int g_exit_status = EXIT_SUCCESS;
+
+static int compare_pred(const void *a, const void *b) {
+    const Pred *x = a, *y = b;
+    return x->cost - y->cost;
+}
+
+// 필요한 메타데이터를 가져온다. 실패하면(사라진 항목 등) find처럼 오류를 알리고
+// 종료 상태를 1로 한 뒤 -1을 돌려준다. 같은 항목의 오류는 한 번만 알린다.
+static int candidate_stat(Candidate *c, const FindPlan *plan) {
+    if (c->have_stat) return c->have_stat > 0 ? 0 : -1;
+    if (statx(c->dirfd, c->name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+              plan->statx_mask | STATX_TYPE, &c->stx) == -1) {
+        fprintf(stderr, "find: '%s': %s\n", c->path, strerror(errno));
+        g_exit_status = EXIT_FAILURE;
+        c->have_stat = -1;
+        return -1;
+    }
+    c->have_stat = 1;
+    c->type = c->stx.stx_mode & S_IFMT;
+    return 0;
+}
+
+static int compare_number(int64_t actual, int cmp, int64_t value) {
+    if (cmp < 0) return actual < value;
+    if (cmp > 0) return actual > value;
+    return actual == value;
+}
+
+/**
+ * @brief 항목이 모든 술어를 만족하는지 평가합니다. 처음 실패한 술어에서 멈춥니다.
+ * @return 만족하면 1, 아니면 0 (stat 실패도 0. 오류는 candidate_stat이 알린다)
+ */
+int evaluate(Candidate *c, const FindPlan *plan) {
+    for (size_t i = 0; i < plan->npreds; i++) {
+        const Pred *p = &plan->preds[i];
+        if (p->statx_mask && candidate_stat(c, plan) == -1) {
+            return 0;
+        }
+        switch (p->kind) {
+            case PRED_TYPE:
+                if (c->type == 0 && candidate_stat(c, plan) == -1) return 0;
+                if (c->type != p->type) return 0;
+                break;
+            case PRED_NAME:
+                if (fnmatch(p->pattern, c->base, p->fnm_flags) != 0) return 0;
+                break;
+            case PRED_SIZE: {
+                // find와 같이 단위 크기로 올림한 값으로 비교한다.
+                int64_t units = ((int64_t)c->stx.stx_size + p->unit - 1) / p->unit;
+                if (!compare_number(units, p->cmp, p->value)) return 0;
+                break;
+            }
+            case PRED_MTIME: {
+                int64_t days = (plan->now - c->stx.stx_mtime.tv_sec) / 86400;
+                if (!compare_number(days, p->cmp, p->value)) return 0;
+                break;
+            }
+            case PRED_NEWER:
+                if (c->stx.stx_mtime.tv_sec < p->ref.tv_sec ||
+                    (c->stx.stx_mtime.tv_sec == p->ref.tv_sec &&
+                     c->stx.stx_mtime.tv_nsec <= p->ref.tv_nsec)) return 0;
+                break;
+        }
+    }
+    return 1;
+}
+
+static void print_match(const char *path, const FindPlan *plan) {
+    fputs(path, stdout);
+    putchar(plan->terminator);
+}
+
+// 한 번에 열어 두는 디렉터리 fd 수의 상한. 이보다 깊으면 바깥쪽 fd를 닫아 두었다가
+// 돌아올 때 ".."로 다시 연다. (c_rm과 같은 방식)
+#define FIND_MAX_OPEN_DIRS 256
+
+// 디렉터리에서 읽어 둔 항목들. 항목마다 d_type 1바이트, 이름, '\0'을 이어 붙인다.
+typedef struct {
+    char *data;
+    size_t len, cap;
+} EntryList;
+
+// 탐색 중인 디렉터리 하나
+typedef struct {
+    int fd;                 // 열린 디렉터리 (-1이면 FIND_MAX_OPEN_DIRS 때문에 잠시 닫아 둠)
+    dev_t dev;              // fd를 닫을 때 기록해 두고, ".."로 다시 열 때 같은 디렉터리인지 확인
+    ino_t ino;
+    EntryList entries;
+    size_t pos;             // 다음에 평가할 항목의 위치
+    size_t path_len;        // path에서 이 디렉터리 경로의 길이
+} FindFrame;
+
+typedef struct {
+    FindFrame *frames;      // 명시적 스택 (재귀 호출 대신)
+    size_t depth, cap;
+    size_t lowest_open;     // frames[lowest_open..depth)의 fd가 열려 있다
+    char *path;             // 출력용 경로 (길이 제한 없음)
+    size_t path_cap;
+    char *dirent_buf;       // 디렉터리 하나를 끝까지 읽은 뒤에 내려가므로 모두 함께 쓴다
+} FindWalk;
+
+// 디렉터리를 끝까지 읽어 항목을 f->entries에 모은다. 평가와 하위 탐색은 그 뒤에 한다.
+static void read_entries(FindWalk *w, FindFrame *f) {
+    long nread;
+    while ((nread = read_dirents(f->fd, w->dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(w->dirent_buf + off);
+            off += d->d_reclen;
+            if (is_dot_or_dotdot(d->d_name)) continue;
+            size_t len = strlen(d->d_name) + 1;
+            f->entries.data = grow_array(f->entries.data, &f->entries.cap, f->entries.len + len + 1, 1);
+            f->entries.data[f->entries.len] = (char)d->d_type;
+            memcpy(f->entries.data + f->entries.len + 1, d->d_name, len);
+            f->entries.len += len + 1;
+        }
+    }
+    if (nread == -1) {
+        fprintf(stderr, "find: '%s': %s\n", w->path, strerror(errno));
+        g_exit_status = EXIT_FAILURE;
+    }
+}
+
+// 열린 디렉터리 fd를 스택에 올리고 항목을 읽는다.
+static void walk_push(FindWalk *w, int fd, size_t path_len) {
+    w->frames = grow_array(w->frames, &w->cap, w->depth + 1, sizeof(FindFrame));
+
+    // 열린 fd가 너무 많으면 가장 바깥쪽 것을 닫는다. 다시 열 때 확인할 수 있도록 dev/ino를 기록한다.
+    if (w->depth - w->lowest_open >= FIND_MAX_OPEN_DIRS) {
+        FindFrame *outer = &w->frames[w->lowest_open];
+        struct stat st;
+        if (fstat(outer->fd, &st) == 0) {
+            outer->dev = st.st_dev;
+            outer->ino = st.st_ino;
+            close(outer->fd);
+            outer->fd = -1;
+            w->lowest_open++;
+        }
+    }
+
+    FindFrame *f = &w->frames[w->depth++];
+    memset(f, 0, sizeof(*f));
+    f->fd = fd;
+    f->path_len = path_len;
+    read_entries(w, f);
+}
+
+/**
+ * @brief 다 본 맨 위 디렉터리를 닫고 스택에서 내린다.
+ * @return 0, 닫아 두었던 부모를 다시 열 수 없으면(그 사이 옮겨짐) -1
+ */
+static int walk_pop(FindWalk *w) {
+    FindFrame *child = &w->frames[w->depth - 1];
+    FindFrame *parent = &w->frames[w->depth - 2];
+
+    if (parent->fd == -1) {
+        // 닫아 두었던 부모를 자식 기준 ".."로 다시 열고, 같은 디렉터리인지 확인한다.
+        int fd = openat(child->fd, "..", O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) != 0 || st.st_dev != parent->dev || st.st_ino != parent->ino) {
+            w->path[parent->path_len] = '\0';
+            fprintf(stderr, "find: '%s': directory was moved during traversal\n", w->path);
+            g_exit_status = EXIT_FAILURE;
+            if (fd != -1) close(fd);
+            return -1;
+        }
+        parent->fd = fd;
+        w->lowest_open--;
+    }
+
+    close(child->fd);
+    free(child->entries.data);
+    w->depth--;
+    w->path[parent->path_len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief 시작 디렉터리 아래를 깊이 우선(전위 순서)으로 탐색합니다.
+ *
+ * 재귀 호출 대신 FindFrame 스택을 쓰고, 디렉터리마다 항목을 모두 읽어 둔 뒤 하나씩
+ * 평가하고 내려가므로 getdents64 버퍼는 하나면 된다. 깊이와 상관없이 C 스택은 일정하다.
+ * @param root_fd 열린 시작 디렉터리 (함수가 끝나면 닫힘)
+ * @param path_len w->path에 들어 있는 시작 디렉터리 경로의 길이
+ */
+void walk_tree(FindWalk *w, int root_fd, size_t path_len, const FindPlan *plan) {
+    w->depth = w->lowest_open = 0;
+    walk_push(w, root_fd, path_len);
+
+    while (w->depth > 0) {
+        FindFrame *f = &w->frames[w->depth - 1];
+        if (f->pos >= f->entries.len) {
+            if (w->depth == 1) {
+                close(f->fd);
+                free(f->entries.data);
+                w->depth--;
+                break;
+            }
+            if (walk_pop(w) != 0) break; // 조상 디렉터리를 다시 열 수 없으면 더 진행하지 않는다.
+            continue;
+        }
+
+        // 항목의 깊이는 스택 높이와 같다. (시작 경로의 바로 아래가 1)
+        unsigned char d_type = (unsigned char)f->entries.data[f->pos];
+        const char *name = f->entries.data + f->pos + 1;
+        size_t name_len = strlen(name);
+        f->pos += name_len + 2;
+
+        w->path = grow_array(w->path, &w->path_cap, f->path_len + name_len + 2, 1);
+        w->path[f->path_len] = '/';
+        memcpy(w->path + f->path_len + 1, name, name_len + 1);
+
+        Candidate c = {0};
+        c.dirfd = f->fd;
+        c.name = c.base = name;
+        c.path = w->path;
+        c.type = (d_type != DT_UNKNOWN) ? DTTOIF(d_type) : 0;
+
+        if (evaluate(&c, plan)) {
+            print_match(w->path, plan);
+        }
+
+        // 더 내려갈 수 있을 때만 디렉터리 여부를 확인한다. (d_type을 모를 때만 stat)
+        if (plan->max_depth >= 0 && w->depth >= (size_t)plan->max_depth) continue;
+        if (c.type == 0 && candidate_stat(&c, plan) == -1) continue;
+        if (!S_ISDIR(c.type)) continue;
+
+        // 하위 디렉터리는 현재 디렉터리 fd를 기준으로 연다. (경로 재탐색 없음)
+        int subfd = openat(f->fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (subfd == -1) {
+            fprintf(stderr, "find: '%s': %s\n", w->path, strerror(errno));
+            g_exit_status = EXIT_FAILURE;
+            continue;
+        }
+        walk_push(w, subfd, f->path_len + 1 + name_len);
+    }
+
+    // 중간에 그만둔 경우 남은 fd를 닫는다.
+    while (w->depth > 0) {
+        FindFrame *f = &w->frames[--w->depth];
+        if (f->fd != -1) close(f->fd);
+        free(f->entries.data);
+    }
+}
+
+// 시작 경로 하나를 처리한다: 자신을 평가하고, 디렉터리면 그 안으로 내려간다.
+void find_from(const char *start, const FindPlan *plan, FindWalk *w) {
+    Candidate c = {0};
+    c.dirfd = AT_FDCWD;
+    c.name = c.path = start;
+    const char *slash = strrchr(start, '/');
+    c.base = (slash && slash[1]) ? slash + 1 : start;
+
+    if (candidate_stat(&c, plan) == -1) {
+        return;
+    }
+    if (evaluate(&c, plan)) {
+        print_match(start, plan);
+    }
+    if (!S_ISDIR(c.type) || plan->max_depth == 0) return;
+
+    int dirfd = open(start, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dirfd == -1) {
+        fprintf(stderr, "find: '%s': %s\n", start, strerror(errno));
+        g_exit_status = EXIT_FAILURE;
+        return;
+    }
+    size_t len = strlen(start);
+    w->path = grow_array(w->path, &w->path_cap, len + 1, 1);
+    memcpy(w->path, start, len + 1);
+    while (len > 1 && w->path[len - 1] == '/') w->path[--len] = '\0'; // "dir//x" 방지
+    if (len == 1 && w->path[0] == '/') w->path[--len] = '\0';          // "/" 아래는 "/x"
+    walk_tree(w, dirfd, len, plan);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "사용법: %s [경로...] [-name 패턴] [-iname 패턴] [-type c] [-size [+-]N[ckMG]]\n"
+                    "       [-mtime [+-]N] [-newer 파일] [-maxdepth N] [-print] [-print0]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+// "+N", "-N", "N" 형식의 숫자를 해석한다. 끝에 남은 단위 문자는 *rest로 돌려준다.
+static int parse_number(const char *arg, int *cmp, int64_t *value, char **rest) {
+    *cmp = 0;
+    if (*arg == '+') { *cmp = 1; arg++; }
+    else if (*arg == '-') { *cmp = -1; arg++; }
+    if (*arg < '0' || *arg > '9') return -1;
+    *value = strtoll(arg, rest, 10);
+    return 0;
+}
+
+/**
+ * @brief 명령줄 식을 술어 목록으로 "컴파일"합니다. 싼 술어가 앞에 오도록 정렬하고
+ *        stat이 필요한 술어들의 요구 필드를 합쳐 둡니다.
+ */
+void compile_plan(int argc, char *argv[], int first, FindPlan *plan) {
+    memset(plan, 0, sizeof(*plan));
+    plan->max_depth = -1;
+    plan->terminator = '\n';
+    plan->now = time(NULL);
+    size_t cap = 0;
+    int have_action = 0;
+
+    for (int i = first; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *arg = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        // find는 식을 왼쪽부터 평가하므로 출력 동작 뒤에 오는 술어는 출력에 영향을 주지 않는다.
+        // 첫 출력 동작이 출력 형식을 정하고, 그 뒤의 술어는 문법만 확인하고 버린다.
+        if (strcmp(opt, "-print") == 0 || strcmp(opt, "-print0") == 0) {
+            if (!have_action) plan->terminator = opt[6] ? '\0' : '\n';
+            have_action = 1;
+            continue;
+        }
+        if (!arg) {
+            fprintf(stderr, "find: missing argument to '%s'\n", opt);
+            exit(EXIT_FAILURE);
+        }
+        i++;
+
+        if (strcmp(opt, "-maxdepth") == 0) {
+            plan->max_depth = atoi(arg);
+            if (plan->max_depth < 0) usage(argv[0]);
+            continue;
+        }
+
+        plan->preds = grow_array(plan->preds, &cap, plan->npreds + 1, sizeof(Pred));
+        Pred *p = &plan->preds[plan->npreds++];
+        memset(p, 0, sizeof(*p));
+
+        if (strcmp(opt, "-name") == 0 || strcmp(opt, "-iname") == 0) {
+            p->kind = PRED_NAME;
+            p->cost = 1;
+            p->pattern = arg;
+            p->fnm_flags = (opt[1] == 'i') ? FNM_CASEFOLD : 0;
+        } else if (strcmp(opt, "-type") == 0) {
+            p->kind = PRED_TYPE;
+            p->cost = 0;
+            switch (arg[0]) {
+                case 'f': p->type = S_IFREG; break;
+                case 'd': p->type = S_IFDIR; break;
+                case 'l': p->type = S_IFLNK; break;
+                case 'b': p->type = S_IFBLK; break;
+                case 'c': p->type = S_IFCHR; break;
+                case 'p': p->type = S_IFIFO; break;
+                case 's': p->type = S_IFSOCK; break;
+                default:
+                    fprintf(stderr, "find: unknown argument to -type: %s\n", arg);
+                    exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(opt, "-size") == 0) {
+            char *rest;
+            p->kind = PRED_SIZE;
+            p->cost = 10;
+            p->statx_mask = STATX_SIZE;
+            if (parse_number(arg, &p->cmp, &p->value, &rest) == -1) usage(argv[0]);
+            switch (*rest) {
+                case '\0': case 'b': p->unit = 512; break;
+                case 'c': p->unit = 1; break;
+                case 'w': p->unit = 2; break;
+                case 'k': p->unit = 1024; break;
+                case 'M': p->unit = 1024 * 1024; break;
+                case 'G': p->unit = 1024 * 1024 * 1024; break;
+                default:
+                    fprintf(stderr, "find: invalid -size unit: %s\n", arg);
+                    exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(opt, "-mtime") == 0) {
+            char *rest;
+            p->kind = PRED_MTIME;
+            p->cost = 10;
+            p->statx_mask = STATX_MTIME;
+            if (parse_number(arg, &p->cmp, &p->value, &rest) == -1 || *rest) usage(argv[0]);
+        } else if (strcmp(opt, "-newer") == 0) {
+            struct statx ref;
+            p->kind = PRED_NEWER;
+            p->cost = 10;
+            p->statx_mask = STATX_MTIME;
+            // 기준 파일은 식을 컴파일할 때 한 번만 stat 한다.
+            if (statx(AT_FDCWD, arg, 0, STATX_MTIME, &ref) == -1) {
+                fprintf(stderr, "find: '%s': %s\n", arg, strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+            p->ref = ref.stx_mtime;
+        } else {
+            fprintf(stderr, "find: unknown predicate '%s'\n", opt);
+            usage(argv[0]);
+        }
+        if (have_action) {
+            plan->npreds--;
+            continue;
+        }
+        plan->statx_mask |= p->statx_mask;
+    }
+
+    // 술어는 모두 AND이고 부작용이 없으므로, 비용 순으로 정렬해도 결과는 같다.
+    qsort(plan->preds, plan->npreds, sizeof(Pred), compare_pred);
+}
+
+int main(int argc, char *argv[]) {
+    // 식이 시작되기 전까지의 인자는 시작 경로다.
+    int first_expr = 1;
+    while (first_expr < argc && argv[first_expr][0] != '-') {
+        first_expr++;
+    }
+
+    FindPlan plan;
+    compile_plan(argc, argv, first_expr, &plan);
+
+    FindWalk walk = {0};
+    walk.dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (!walk.dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (first_expr == 1) {
+        find_from(".", &plan, &walk); // 경로가 없으면 현재 디렉터리
+    }
+    for (int i = 1; i < first_expr; i++) {
+        find_from(argv[i], &plan, &walk);
+    }
+
+    free(walk.dirent_buf);
+    free(walk.frames);
+    free(walk.path);
+    free(plan.preds);
+    return g_exit_status;
+}
@@ -0,0 +1,221 @@
+#ifndef C_IDCACHE_H
+#define C_IDCACHE_H
+
+// uid/gid -> 이름 변환 캐시. c_ls와 c_ps가 함께 쓴다.
+//
+// getpwuid/getgrgid는 NSS 설정에 따라 매번 /etc/passwd를 처음부터 읽거나
+// SSSD/LDAP에 질의하므로, 같은 id를 여러 번 찾으면 그만큼 느려진다.
+// 한 번 찾은 결과는 프로세스가 끝날 때까지 기억하고, 이름이 없는 id도
+// 숫자 문자열로 기억하여(부정 캐시) 다시 NSS에 묻지 않는다.
+// idcache_warm()을 부르면 /etc/passwd와 /etc/group을 한 번에 읽어 미리 채운다.
+//
+// 여러 스레드에서 호출해도 된다. (c_ls -j) 찾은 이름은 해제되지 않으므로
+// 돌려받은 포인터는 프로그램이 끝날 때까지 유효하다.
+// c_walk.h처럼 모두 static inline 함수로 두어, 일부만 써도 경고가 나지 않는다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pwd.h>
+#include <grp.h>
+#include <pthread.h>
+
+typedef struct {
+    uint32_t id;
+    const char *name;   // NULL이면 빈 슬롯
+    size_t len;
+} IdEntry;
+
+// 개방 주소법 해시 테이블. 읽기는 여럿이 동시에, 추가는 하나씩 한다.
+typedef struct {
+    pthread_rwlock_t lock;
+    IdEntry *slots;
+    size_t cap, count;  // cap은 2의 거듭제곱
+} IdTable;
+
+static IdTable g_user_ids = { PTHREAD_RWLOCK_INITIALIZER, NULL, 0, 0 };
+static IdTable g_group_ids = { PTHREAD_RWLOCK_INITIALIZER, NULL, 0, 0 };
+
+static inline size_t idtable_hash(uint32_t id, size_t cap) {
+    return (size_t)(id * 0x9E3779B1u) & (cap - 1);
+}
+
+// id의 슬롯을 찾는다. 없으면 NULL. (잠금을 잡은 상태에서 호출)
+static inline const IdEntry *idtable_find(const IdTable *t, uint32_t id) {
+    if (t->cap == 0) return NULL;
+    for (size_t i = idtable_hash(id, t->cap); t->slots[i].name; i = (i + 1) & (t->cap - 1)) {
+        if (t->slots[i].id == id) return &t->slots[i];
+    }
+    return NULL;
+}
+
+// 이름을 복사해 넣는다. 이미 있으면 기존 것을 돌려준다. (쓰기 잠금을 잡은 상태에서 호출)
+static inline const IdEntry *idtable_insert(IdTable *t, uint32_t id, const char *name) {
+    const IdEntry *found = idtable_find(t, id);
+    if (found) return found;
+
+    // 절반 이상 차면 두 배로 늘리고 다시 넣는다.
+    if ((t->count + 1) * 2 > t->cap) {
+        size_t new_cap = t->cap ? t->cap * 2 : 64;
+        IdEntry *slots = calloc(new_cap, sizeof(IdEntry));
+        if (!slots) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < t->cap; i++) {
+            if (!t->slots[i].name) continue;
+            size_t j = idtable_hash(t->slots[i].id, new_cap);
+            while (slots[j].name) j = (j + 1) & (new_cap - 1);
+            slots[j] = t->slots[i];
+        }
+        free(t->slots);
+        t->slots = slots;
+        t->cap = new_cap;
+    }
+
+    char *copy = strdup(name);
+    if (!copy) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    size_t i = idtable_hash(id, t->cap);
+    while (t->slots[i].name) i = (i + 1) & (t->cap - 1);
+    t->slots[i].id = id;
+    t->slots[i].name = copy;
+    t->slots[i].len = strlen(copy);
+    t->count++;
+    return &t->slots[i];
+}
+
+// NSS에 직접 묻는다. 찾으면 name에 복사하고 1, 없으면 0.
+static inline int idcache_query(uint32_t id, int is_group, char *name, size_t size) {
+    char stack_buf[4096];
+    char *buf = stack_buf;
+    size_t buf_size = sizeof(stack_buf);
+    int found = 0;
+
+    for (;;) {
+        int err;
+        if (is_group) {
+            struct group gr, *result = NULL;
+            err = getgrgid_r((gid_t)id, &gr, buf, buf_size, &result);
+            if (err == 0 && result) {
+                snprintf(name, size, "%s", result->gr_name);
+                found = 1;
+            }
+        } else {
+            struct passwd pw, *result = NULL;
+            err = getpwuid_r((uid_t)id, &pw, buf, buf_size, &result);
+            if (err == 0 && result) {
+                snprintf(name, size, "%s", result->pw_name);
+                found = 1;
+            }
+        }
+        // 멤버가 많은 그룹 등은 버퍼가 모자랄 수 있으므로 늘려서 다시 시도한다.
+        if (err != ERANGE || buf_size >= 1024 * 1024) break;
+        if (buf != stack_buf) free(buf);
+        buf_size *= 2;
+        buf = malloc(buf_size);
+        if (!buf) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (buf != stack_buf) free(buf);
+    return found;
+}
+
+static inline const char *idcache_lookup(IdTable *t, uint32_t id, int is_group, size_t *len) {
+    // 슬롯 배열은 다른 스레드의 추가로 옮겨질 수 있으므로 잠금 안에서 값을 복사해 둔다.
+    // (이름 문자열 자체는 옮겨지지 않는다)
+    const char *result = NULL;
+    size_t result_len = 0;
+
+    pthread_rwlock_rdlock(&t->lock);
+    const IdEntry *e = idtable_find(t, id);
+    if (e) {
+        result = e->name;
+        result_len = e->len;
+    }
+    pthread_rwlock_unlock(&t->lock);
+
+    if (!result) {
+        // NSS 질의는 느릴 수 있으므로 잠금 밖에서 한다.
+        // 두 스레드가 같은 id를 동시에 찾으면 먼저 넣은 쪽이 남는다.
+        char name[256];
+        if (!idcache_query(id, is_group, name, sizeof(name))) {
+            snprintf(name, sizeof(name), "%u", (unsigned int)id); // 부정 캐시: 숫자 그대로
+        }
+        pthread_rwlock_wrlock(&t->lock);
+        e = idtable_insert(t, id, name);
+        result = e->name;
+        result_len = e->len;
+        pthread_rwlock_unlock(&t->lock);
+    }
+    if (len) *len = result_len;
+    return result;
+}
+
+/**
+ * @brief UID를 사용자 이름으로 바꿉니다. 이름이 없으면 UID 숫자 문자열을 돌려줍니다.
+ * @param len NULL이 아니면 이름의 길이를 저장
+ */
+static inline const char *idcache_user(uid_t uid, size_t *len) {
+    return idcache_lookup(&g_user_ids, (uint32_t)uid, 0, len);
+}
+
+/**
+ * @brief GID를 그룹 이름으로 바꿉니다. 이름이 없으면 GID 숫자 문자열을 돌려줍니다.
+ * @param len NULL이 아니면 이름의 길이를 저장
+ */
+static inline const char *idcache_group(gid_t gid, size_t *len) {
+    return idcache_lookup(&g_group_ids, (uint32_t)gid, 1, len);
+}
+
+// "name:x:id:..." 형식의 파일을 읽어 테이블에 넣는다. 같은 id가 여러 번 나오면 처음 것을 쓴다.
+static inline void idcache_load_file(IdTable *t, const char *path) {
+    FILE *fp = fopen(path, "re");
+    if (!fp) return; // 파일이 없으면 필요할 때 NSS로 찾는다.
+
+    char *line = NULL;
+    size_t line_cap = 0;
+    pthread_rwlock_wrlock(&t->lock);
+    while (getline(&line, &line_cap, fp) != -1) {
+        if (line[0] == '#' || line[0] == '+' || line[0] == '-') {
+            continue; // 주석이나 NIS 호환 항목
+        }
+        char *name = line;
+        char *colon1 = strchr(name, ':');
+        char *colon2 = colon1 ? strchr(colon1 + 1, ':') : NULL;
+        if (!colon2 || colon1 == name) continue; // 잘못된 줄
+        char *end;
+        unsigned long id = strtoul(colon2 + 1, &end, 10);
+        if (end == colon2 + 1 || *end != ':' || id > UINT32_MAX) continue;
+        *colon1 = '\0';
+        idtable_insert(t, (uint32_t)id, name);
+    }
+    pthread_rwlock_unlock(&t->lock);
+    free(line);
+    fclose(fp);
+}
+
+static inline void idcache_load_all(void) {
+    idcache_load_file(&g_user_ids, "/etc/passwd");
+    idcache_load_file(&g_group_ids, "/etc/group");
+}
+
+/**
+ * @brief /etc/passwd와 /etc/group을 한 번에 읽어 캐시를 미리 채웁니다.
+ *
+ * 많은 id를 찾을 것이 예상될 때(ls -l, ps -f) 부르면 id마다 NSS를 거치지 않는다.
+ * 파일에 없는 id(LDAP 사용자 등)는 처음 찾을 때 평소처럼 NSS에 묻는다.
+ * 여러 번 불러도 한 번만 읽는다.
+ */
+static inline void idcache_warm(void) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, idcache_load_all);
+}
+
+#endif // C_IDCACHE_H
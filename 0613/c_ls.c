@@ -1,182 +1,1425 @@
+#define _GNU_SOURCE     // for statx, O_DIRECTORY
 #include <stdio.h>
 #include <stdlib.h>     // for qsort, exit
 #include <string.h>     // for strcmp, snprintf
-#include <unistd.h>     // for getopt
-#include <dirent.h>     // for opendir, readdir, closedir
-#include <sys/stat.h>   // for stat structure
-#include <time.h>       // for localtime, strftime
-#include <pwd.h>        // for getpwuid (사용자 이름 가져오기)
-#include <grp.h>        // for getgrgid (그룹 이름 가져오기)
-
-// 파일 하나의 정보를 저장하기 위한 구조체
-// 정렬을 위해 파일 이름과 stat 정보를 함께 저장해야 함
+#include <unistd.h>     // for getopt, syscall
+#include <dirent.h>     // for DT_* 상수
+#include <fcntl.h>      // for openat, AT_FDCWD
+#include <stdint.h>     // for uint64_t
+#include <sys/stat.h>   // for stat structure, statx
+#include <time.h>       // for localtime_r, strftime
+#include <pthread.h>    // for -j 병렬 탐색
+#include <stdatomic.h>  // for 작업 상태/참조 카운트
+#include <errno.h>      // for io_uring 완료 코드 해석
+#include <getopt.h>     // for getopt_long (--cache)
+#include <sys/mman.h>   // for mmap (--cache 파일)
+#include <sys/ioctl.h>  // for TIOCGWINSZ (-C 터미널 너비)
+#include "c_uring.h"    // io_uring 최소 래퍼 (STATX 일괄 처리)
+#include "c_walk.h"     // getdents64 읽기, 작업 덱 등 탐색 도구 공용 부품
+#include "c_idcache.h"  // uid/gid -> 이름 캐시 (c_ps와 공유)
+
+// -U/-f 스트리밍 모드에서 쓰는 표준 출력 버퍼 크기
+#define STREAM_OUT_BUF_SIZE (1024 * 1024)
+
+// io_uring 링에 한 번에 올려 둘 STATX 요청 수. 요청마다 struct statx 버퍼가 하나씩 필요하다.
+#define STATX_BATCH 256
+
+typedef struct LsCache LsCache; // --cache 상태 (아래에서 정의)
+
+// 명령줄 옵션을 담는 구조체. 함수마다 플래그를 하나씩 넘기는 대신 통째로 전달한다.
+typedef struct {
+    int show_all;       // -a
+    int long_format;    // -l
+    int recursive;      // -R
+    int sort_time;      // -t
+    int sort_size;      // -S
+    int unsorted;       // -U, -f: 정렬/버퍼링 없이 읽는 즉시 출력
+    int columns;        // -C: 여러 열로 출력 (터미널이면 기본)
+    int one_per_line;   // -1: 한 줄에 하나씩 출력
+    size_t line_width;  // -C에서 쓸 터미널 너비 (-w N)
+    int jobs;           // -j N: -R 탐색에 사용할 작업 스레드 수 (0이면 단일 스레드)
+    LsCache *cache;     // --cache FILE: 디렉터리 목록 캐시 (없으면 NULL)
+    unsigned int statx_mask; // 항목마다 필요한 메타데이터 (0이면 stat을 생략)
+} LsOptions;
+
+// 항목 하나의 핫 데이터. 정렬/출력 때 항상 필요한 것만 담는다.
+// 이름 자체는 EntryArena.names에 연속으로 저장하고 여기서는 오프셋만 기억한다.
+typedef struct {
+    size_t name_off;     // names 버퍼 안에서 이름('\0'으로 끝남)의 시작 위치
+    mode_t mode;         // 파일 종류와 권한 (d_type만 알 때는 종류 비트만 유효)
+} EntryHot;
+
+// -l/-t/-S가 요청할 때만 채우는 메타데이터. (struct stat 전체보다 훨씬 작다)
+typedef struct {
+    int64_t mtime;       // 최종 수정 시간
+    int64_t size;        // 파일 크기
+    uint32_t nlink;      // 하드 링크 수
+    uint32_t uid;        // 소유자
+    uint32_t gid;        // 그룹
+} EntryMeta;
+
+// 디렉터리 하나의 항목들을 담는 가변 크기 저장소
+// 항목 수에 제한이 없으며, 배열은 필요할 때마다 2배씩 늘어난다.
 typedef struct {
-    char name[256];      // 파일 이름
-    struct stat st;      // 파일의 모든 메타데이터 (크기, 시간, 권한 등)
-} FileInfo;
+    char *names;         // 모든 이름을 '\0'으로 구분해 이어 붙인 버퍼
+    size_t names_len, names_cap;
+    EntryHot *hot;       // 항목별 핫 데이터
+    EntryMeta *meta;     // 항목별 메타데이터 (메타데이터가 필요 없으면 NULL)
+    uint32_t *order;     // 정렬 결과 (hot/meta를 직접 옮기지 않고 인덱스만 정렬)
+    size_t count, cap;
+    int with_meta;       // meta 배열을 유지할지 여부
+} EntryArena;
+
+void arena_init(EntryArena *arena, int with_meta) {
+    memset(arena, 0, sizeof(*arena));
+    arena->with_meta = with_meta;
+}
+
+void arena_free(EntryArena *arena) {
+    free(arena->names);
+    free(arena->hot);
+    free(arena->meta);
+    free(arena->order);
+}
+
+// 할당된 메모리는 유지한 채 항목만 비운다. (스트리밍 모드에서 버퍼마다 재사용)
+void arena_reset(EntryArena *arena) {
+    arena->count = 0;
+    arena->names_len = 0;
+}
+
+// 새 항목을 추가하고 인덱스를 돌려준다. 이름은 names 버퍼 끝에 복사된다.
+size_t arena_add(EntryArena *arena, const char *name, mode_t mode) {
+    if (arena->count >= UINT32_MAX) {
+        fprintf(stderr, "ls: too many entries\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t len = strlen(name) + 1;
+    size_t idx = arena->count;
+    size_t cap = arena->cap;
+
+    arena->names = grow_array(arena->names, &arena->names_cap, arena->names_len + len, 1);
+    memcpy(arena->names + arena->names_len, name, len);
+
+    arena->hot = grow_array(arena->hot, &arena->cap, idx + 1, sizeof(EntryHot));
+    if (arena->with_meta) {
+        // hot과 같은 용량을 유지한다. (cap은 hot을 늘릴 때 이미 갱신됨)
+        size_t meta_cap = cap;
+        arena->meta = grow_array(arena->meta, &meta_cap, arena->cap, sizeof(EntryMeta));
+    }
+    arena->hot[idx].name_off = arena->names_len;
+    arena->hot[idx].mode = mode;
+    arena->names_len += len;
+    arena->count++;
+    return idx;
+}
 
-// qsort를 위한 비교 함수: 수정 시간(mtime) 기준 내림차순 정렬
-// 최신 파일이 먼저 오도록 정렬한다.
-int compare_mtime(const void *a, const void *b) {
-    FileInfo *fileA = (FileInfo *)a;
-    FileInfo *fileB = (FileInfo *)b;
-    // b의 시간이 더 크면(최신이면) 양수를 반환하여 b를 앞으로 보냄
-    return fileB->st.st_mtime - fileA->st.st_mtime;
+static inline const char *entry_name(const EntryArena *arena, size_t idx) {
+    return arena->names + arena->hot[idx].name_off;
 }
 
-// qsort를 위한 비교 함수: 파일 크기(size) 기준 내림차순 정렬
+// qsort_r을 위한 비교 함수: 수정 시간(mtime) 기준 내림차순 정렬
+// 최신 파일이 먼저 오도록 정렬하고, 시간이 같으면 읽은 순서를 유지한다.
+int compare_mtime(const void *a, const void *b, void *ctx) {
+    const EntryArena *arena = ctx;
+    uint32_t ia = *(const uint32_t *)a, ib = *(const uint32_t *)b;
+    int64_t ta = arena->meta[ia].mtime, tb = arena->meta[ib].mtime;
+    if (ta != tb) return (ta < tb) ? 1 : -1;
+    return (ia > ib) - (ia < ib);
+}
+
+// qsort_r을 위한 비교 함수: 파일 크기(size) 기준 내림차순 정렬
 // 크기가 큰 파일이 먼저 오도록 정렬한다.
-int compare_size(const void *a, const void *b) {
-    FileInfo *fileA = (FileInfo *)a;
-    FileInfo *fileB = (FileInfo *)b;
-    // b의 크기가 더 크면 양수를 반환하여 b를 앞으로 보냄
-    return fileB->st.st_size - fileA->st.st_size;
+int compare_size(const void *a, const void *b, void *ctx) {
+    const EntryArena *arena = ctx;
+    uint32_t ia = *(const uint32_t *)a, ib = *(const uint32_t *)b;
+    int64_t sa = arena->meta[ia].size, sb = arena->meta[ib].size;
+    if (sa != sb) return (sa < sb) ? 1 : -1;
+    return (ia > ib) - (ia < ib);
 }
 
-// stat 구조체의 st_mode 값을 해석하여 파일 권한을 출력하는 함수
-void print_permissions(mode_t mode) {
-    // 1. 파일 종류 출력 (디렉토리, 일반 파일 등)
-    printf(S_ISDIR(mode) ? "d" : "-");
+// --- 출력 렌더러 ---
+//
+// 항목마다 printf/fputs를 여러 번 부르는 대신 큰 버퍼 하나에 직접 써 넣고,
+// 디렉터리(또는 스트리밍 청크) 하나가 끝나면 한 번에 내보낸다.
+//  - 권한 문자열: 종류 문자 표 + rwx 3비트 조합 표
+//  - 숫자: 뒤에서부터 자릿수를 채우는 itoa
+//  - 시각: 같은 (현지 시간) 한 시간 안의 시각은 localtime_r/strftime 결과를 재사용
+//  - -l 열 너비와 -C 열 배치는 항목들을 한 번 훑어서 계산
+
+// -C에서 열 하나의 최소 너비 (이름 1글자 + 구분 공백 2칸, GNU ls와 같음)
+#define MIN_COLUMN_WIDTH 3
+
+// 시각 캐시 슬롯 수. 슬롯은 (시각 / 3600)으로 고른다.
+#define TIME_CACHE_SLOTS 64
+
+// 디렉터리 출력이 쌓이는 버퍼
+typedef struct {
+    char *data;
+    size_t len, cap;
+} OutBuf;
+
+// 현지 시간으로 한 시간 구간 하나에 대한 "Mon DD HH:" 문자열
+// 서머타임 전환은 정시에 일어나므로 구간 안에서는 분만 다르다.
+typedef struct {
+    int64_t hour_start;  // 구간 시작 시각 (epoch 초)
+    char prefix[24];
+    size_t prefix_len;   // 0이면 빈 슬롯
+} TimeSlot;
 
-    // 2. 소유자(User)의 권한 (읽기, 쓰기, 실행)
-    printf((mode & S_IRUSR) ? "r" : "-");
-    printf((mode & S_IWUSR) ? "w" : "-");
-    printf((mode & S_IXUSR) ? "x" : "-");
+// 바로 전에 찾은 uid/gid의 이름. 한 디렉터리의 항목은 보통 소유자가 같으므로
+// 공용 캐시(c_idcache.h)의 잠금조차 거치지 않고 바로 쓴다.
+typedef struct {
+    uint32_t id;
+    const char *name;    // NULL이면 아직 없음 (캐시가 가진 문자열을 가리킨다)
+    size_t len;
+} NameMemo;
 
-    // 3. 그룹(Group)의 권한
-    printf((mode & S_IRGRP) ? "r" : "-");
-    printf((mode & S_IWGRP) ? "w" : "-");
-    printf((mode & S_IXGRP) ? "x" : "-");
+// 스레드마다 하나씩 두는 렌더러 상태
+typedef struct {
+    OutBuf out;
+    TimeSlot times[TIME_CACHE_SLOTS];
+    NameMemo user, group;
+} Renderer;
 
-    // 4. 그 외 사용자(Others)의 권한
-    printf((mode & S_IROTH) ? "r" : "-");
-    printf((mode & S_IWOTH) ? "w" : "-");
-    printf((mode & S_IXOTH) ? "x" : "-");
+static inline void out_reserve(OutBuf *out, size_t n) {
+    out->data = grow_array(out->data, &out->cap, out->len + n, 1);
 }
 
-// ls -l 형식에 맞춰 파일의 상세 정보를 출력하는 함수
-void print_long_format(FileInfo *f) {
-    // 권한 출력
-    print_permissions(f->st.st_mode);
+static inline void out_write(OutBuf *out, const char *s, size_t n) {
+    out_reserve(out, n);
+    memcpy(out->data + out->len, s, n);
+    out->len += n;
+}
 
-    // 링크 수, 소유자 이름, 그룹 이름, 파일 크기 출력
-    printf(" %2lu", f->st.st_nlink);
-    printf(" %-8s", getpwuid(f->st.st_uid)->pw_name);
-    printf(" %-8s", getgrgid(f->st.st_gid)->gr_name);
-    printf(" %8ld", f->st.st_size);
+static inline void out_char(OutBuf *out, char c) {
+    out_reserve(out, 1);
+    out->data[out->len++] = c;
+}
 
-    // 최종 수정 시간을 보기 좋은 형식으로 변환하여 출력
-    char timebuf[20];
-    strftime(timebuf, sizeof(timebuf), "%b %d %H:%M", localtime(&f->st.st_mtime));
-    printf(" %s", timebuf);
+static inline void out_spaces(OutBuf *out, size_t n) {
+    out_reserve(out, n);
+    memset(out->data + out->len, ' ', n);
+    out->len += n;
+}
 
-    // 파일 이름 출력
-    printf(" %s\n", f->name);
+// 버퍼 내용을 파일로 내보내고 비운다. (할당된 메모리는 재사용)
+void out_flush(OutBuf *out, FILE *fp) {
+    if (out->len > 0) {
+        fwrite(out->data, 1, out->len, fp);
+        out->len = 0;
+    }
 }
 
-// 핵심 로직: 특정 디렉터리의 내용을 목록으로 보여주는 함수
-void list_directory(const char *path, int show_all, int long_format, int recursive, int sort_time, int sort_size) {
-    DIR *dir; // 디렉터리 스트림을 가리키는 포인터
-    struct dirent *entry; // 디렉터리 내의 항목(파일/디렉토리)을 가리키는 포인터
+// 부호 없는 정수를 end 바로 앞에서부터 거꾸로 채우고 자릿수를 돌려준다.
+static inline size_t format_uint(char *end, uint64_t v) {
+    char *p = end;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return (size_t)(end - p);
+}
 
-    // opendir()로 지정된 경로의 디렉터리를 연다.
-    if (!(dir = opendir(path))) {
-        perror("opendir");
+static inline size_t uint_width(uint64_t v) {
+    size_t w = 1;
+    while (v >= 10) {
+        v /= 10;
+        w++;
+    }
+    return w;
+}
+
+// 정수를 width 칸에 오른쪽 정렬하여 쓴다.
+static void out_uint(OutBuf *out, uint64_t v, size_t width) {
+    char tmp[24];
+    size_t n = format_uint(tmp + sizeof(tmp), v);
+    if (width > n) out_spaces(out, width - n);
+    out_write(out, tmp + sizeof(tmp) - n, n);
+}
+
+// st_mode의 종류 비트((mode >> 12) & 0xF)별 문자: FIFO, 문자 장치, 디렉터리, 블록 장치, 일반, 링크, 소켓
+static const char mode_type_chars[16] = "?pc?d?b?-?l?s???";
+
+// rwx 3비트 조합별 문자열
+static const char perm_triplets[8][3] = {
+    {'-','-','-'}, {'-','-','x'}, {'-','w','-'}, {'-','w','x'},
+    {'r','-','-'}, {'r','-','x'}, {'r','w','-'}, {'r','w','x'},
+};
+
+// st_mode 값을 "drwxr-xr-x" 형식의 10글자로 바꾼다. (setuid/setgid/sticky 포함)
+static void format_mode(char dst[10], mode_t mode) {
+    dst[0] = mode_type_chars[(mode >> 12) & 0xF];
+    memcpy(dst + 1, perm_triplets[(mode >> 6) & 7], 3);
+    memcpy(dst + 4, perm_triplets[(mode >> 3) & 7], 3);
+    memcpy(dst + 7, perm_triplets[mode & 7], 3);
+    if (mode & S_ISUID) dst[3] = (mode & S_IXUSR) ? 's' : 'S';
+    if (mode & S_ISGID) dst[6] = (mode & S_IXGRP) ? 's' : 'S';
+    if (mode & S_ISVTX) dst[9] = (mode & S_IXOTH) ? 't' : 'T';
+}
+
+// 수정 시각을 "Mon DD HH:MM" 형식으로 쓴다.
+static void out_time(Renderer *r, int64_t t) {
+    TimeSlot *slot = &r->times[(uint64_t)(t / 3600) % TIME_CACHE_SLOTS];
+    if (slot->prefix_len == 0 || t < slot->hour_start || t >= slot->hour_start + 3600) {
+        time_t tt = (time_t)t;
+        struct tm tm;
+        if (!localtime_r(&tt, &tm)) {
+            out_char(&r->out, '?');
+            return;
+        }
+        slot->hour_start = t - tm.tm_min * 60 - tm.tm_sec;
+        slot->prefix_len = strftime(slot->prefix, sizeof(slot->prefix), "%b %d %H:", &tm);
+    }
+    unsigned minute = (unsigned)((t - slot->hour_start) / 60);
+    char mm[2] = { (char)('0' + minute / 10), (char)('0' + minute % 10) };
+    out_write(&r->out, slot->prefix, slot->prefix_len);
+    out_write(&r->out, mm, 2);
+}
+
+static const NameMemo *user_name(Renderer *r, uint32_t uid) {
+    if (!r->user.name || r->user.id != uid) {
+        r->user.name = idcache_user(uid, &r->user.len);
+        r->user.id = uid;
+    }
+    return &r->user;
+}
+
+static const NameMemo *group_name(Renderer *r, uint32_t gid) {
+    if (!r->group.name || r->group.id != gid) {
+        r->group.name = idcache_group(gid, &r->group.len);
+        r->group.id = gid;
+    }
+    return &r->group;
+}
+
+// order가 NULL이면 읽은 순서 그대로다. (스트리밍 모드)
+static inline size_t nth_entry(const uint32_t *order, size_t i) {
+    return order ? order[i] : i;
+}
+
+// ls -l 형식으로 출력한다. 먼저 한 번 훑어 링크 수/소유자/그룹/크기 열의 너비를 구한다.
+void render_long(Renderer *r, const EntryArena *arena, const uint32_t *order) {
+    size_t w_nlink = 1, w_user = 1, w_group = 1, w_size = 1;
+    for (size_t i = 0; i < arena->count; i++) {
+        const EntryMeta *m = &arena->meta[nth_entry(order, i)];
+        size_t w;
+        if ((w = uint_width(m->nlink)) > w_nlink) w_nlink = w;
+        if ((w = uint_width((uint64_t)m->size)) > w_size) w_size = w;
+        if ((w = user_name(r, m->uid)->len) > w_user) w_user = w;
+        if ((w = group_name(r, m->gid)->len) > w_group) w_group = w;
+    }
+
+    for (size_t i = 0; i < arena->count; i++) {
+        size_t idx = nth_entry(order, i);
+        const EntryMeta *m = &arena->meta[idx];
+        const NameMemo *user = user_name(r, m->uid);
+        const NameMemo *group = group_name(r, m->gid);
+        const char *name = entry_name(arena, idx);
+        char mode[10];
+
+        format_mode(mode, arena->hot[idx].mode);
+        out_write(&r->out, mode, sizeof(mode));
+        out_char(&r->out, ' ');
+        out_uint(&r->out, m->nlink, w_nlink);
+        out_char(&r->out, ' ');
+        out_write(&r->out, user->name, user->len);
+        out_spaces(&r->out, w_user - user->len + 1);
+        out_write(&r->out, group->name, group->len);
+        out_spaces(&r->out, w_group - group->len + 1);
+        out_uint(&r->out, (uint64_t)m->size, w_size);
+        out_char(&r->out, ' ');
+        out_time(r, m->mtime);
+        out_char(&r->out, ' ');
+        out_write(&r->out, name, strlen(name));
+        out_char(&r->out, '\n');
+    }
+}
+
+/**
+ * @brief GNU ls -C와 같은 방식으로 이름을 여러 열(위에서 아래로 채움)로 출력합니다.
+ * @param width 터미널 너비
+ *
+ * 가능한 열 수마다 열 너비 배열을 두고, 항목들을 한 번 훑으면서 모든 배치의
+ * 줄 길이를 동시에 갱신한다. 줄 길이가 너비 안에 드는 가장 많은 열 수를 고른다.
+ */
+void render_columns(Renderer *r, const EntryArena *arena, const uint32_t *order, size_t width) {
+    size_t n = arena->count;
+    if (n == 0) return;
+
+    size_t max_cols = width / MIN_COLUMN_WIDTH;
+    if (max_cols == 0) max_cols = 1;
+    if (max_cols > n) max_cols = n;
+
+    // 배치 c(열 c+1개)의 열 너비는 col_widths[c * (c + 1) / 2 ...]에 있다.
+    size_t *col_widths = malloc(max_cols * (max_cols + 1) / 2 * sizeof(size_t));
+    size_t *line_len = malloc(max_cols * sizeof(size_t));
+    size_t *name_len = malloc(n * sizeof(size_t));
+    if (!col_widths || !line_len || !name_len) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t c = 0; c < max_cols; c++) {
+        line_len[c] = (c + 1) * MIN_COLUMN_WIDTH;
+        for (size_t k = 0; k <= c; k++) col_widths[c * (c + 1) / 2 + k] = MIN_COLUMN_WIDTH;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        name_len[i] = strlen(entry_name(arena, nth_entry(order, i)));
+        for (size_t c = 0; c < max_cols; c++) {
+            if (line_len[c] >= width) continue; // 이미 너비를 넘은 배치
+            size_t ncols = c + 1;
+            size_t rows = (n + ncols - 1) / ncols;
+            size_t col = i / rows;
+            size_t real = name_len[i] + (col == ncols - 1 ? 0 : 2);
+            size_t *cw = &col_widths[c * (c + 1) / 2 + col];
+            if (*cw < real) {
+                line_len[c] += real - *cw;
+                *cw = real;
+            }
+        }
+    }
+
+    size_t ncols = 1;
+    for (size_t c = max_cols; c-- > 0; ) {
+        if (line_len[c] < width) {
+            ncols = c + 1;
+            break;
+        }
+    }
+    const size_t *cw = &col_widths[(ncols - 1) * ncols / 2];
+    size_t rows = (n + ncols - 1) / ncols;
+
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < ncols; col++) {
+            size_t i = row + col * rows;
+            if (i >= n) break;
+            out_write(&r->out, entry_name(arena, nth_entry(order, i)), name_len[i]);
+            // 줄의 마지막 이름 뒤에는 공백을 붙이지 않는다.
+            if (i + rows < n && col + 1 < ncols) {
+                out_spaces(&r->out, cw[col] - name_len[i]);
+            }
+        }
+        out_char(&r->out, '\n');
+    }
+    free(col_widths);
+    free(line_len);
+    free(name_len);
+}
+
+// 옵션에 맞는 형식으로 항목들을 렌더러 버퍼에 쓴다.
+// 기본 형식("이름\t")은 줄바꿈을 붙이지 않으므로 호출자가 마지막에 붙인다.
+void render_entries(Renderer *r, const EntryArena *arena, const uint32_t *order, const LsOptions *opts) {
+    if (opts->long_format) {
+        render_long(r, arena, order);
+        return;
+    }
+    if (opts->columns) {
+        render_columns(r, arena, order, opts->line_width);
         return;
     }
+    for (size_t i = 0; i < arena->count; i++) {
+        const char *name = entry_name(arena, nth_entry(order, i));
+        out_write(&r->out, name, strlen(name));
+        out_char(&r->out, opts->one_per_line ? '\n' : '\t');
+    }
+}
 
-    FileInfo files[1024]; // 파일 정보들을 저장할 배열 (최대 1024개로 제한)
-    int count = 0; // 디렉터리 내 항목의 개수
+// 기본 형식처럼 항목 뒤에 탭을 붙여 한 줄로 출력하는지
+static inline int uses_tab_layout(const LsOptions *opts) {
+    return !opts->long_format && !opts->columns && !opts->one_per_line;
+}
 
-    // readdir()을 반복 호출하여 디렉터리 내의 모든 항목을 읽는다.
-    while ((entry = readdir(dir)) != NULL) {
-        // -a 옵션이 없으면 '.'으로 시작하는 숨김 파일은 건너뛴다.
-        if (!show_all && entry->d_name[0] == '.') {
-            continue;
+// 옵션에 따라 항목마다 statx로 요청할 필드를 결정한다.
+// 이름만 출력하는 경우에는 0을 돌려주어 stat 자체를 생략하게 한다.
+unsigned int compute_statx_mask(const LsOptions *opts) {
+    unsigned int mask = 0;
+    if (opts->long_format) {
+        mask |= STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_UID | STATX_GID |
+                STATX_SIZE | STATX_MTIME;
+    }
+    if (opts->sort_time) mask |= STATX_TYPE | STATX_MTIME;
+    if (opts->sort_size) mask |= STATX_TYPE | STATX_SIZE;
+    // -R은 하위 디렉터리인지만 알면 되므로 d_type으로 충분하다. (DT_UNKNOWN일 때만 stat)
+    return mask;
+}
+
+// 스레드마다 하나씩 두는 작업 버퍼 모음
+// getdents64 버퍼와, 사용 가능하면 STATX 요청을 모아 보낼 io_uring 링을 가진다.
+typedef struct {
+    char *dirent_buf;           // getdents64가 채워줄 버퍼
+    Uring ring;
+    int has_ring;               // io_uring 링을 만들었는지
+    int use_ring;               // STATX를 링으로 보낼지 (커널이 STATX를 모르면 0으로 바뀜)
+    struct statx *statx_bufs;   // 링에 올라간 요청별 결과 버퍼 (STATX_BATCH개)
+    uint32_t *slot_entry;       // 결과 버퍼 슬롯 -> arena 항목 인덱스
+    Renderer render;            // 출력 버퍼와 시각/이름 캐시
+} ScanContext;
+
+void scan_context_init(ScanContext *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (!ctx->dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    // 커널이 너무 오래됐거나 seccomp로 막혀 있으면 여기서 실패하고 동기 방식으로 동작한다.
+    // 커널은 STATX 요청을 io-wq 작업 스레드로 넘겨 처리하므로, CPU가 하나뿐이면 겹쳐 실행될
+    // 곳이 없어 넘기는 비용만 늘어난다. 그래서 c_rm처럼 CPU가 둘 이상일 때만 링을 쓴다.
+    // bench/ls_statx.sh의 비교용으로, -DC_LS_NO_URING으로 빌드하면 항상 동기 방식이고
+    // -DC_LS_FORCE_URING으로 빌드하면 CPU 수와 상관없이 링을 쓴다.
+#ifndef C_LS_NO_URING
+#ifdef C_LS_FORCE_URING
+    int want_ring = 1;
+#else
+    int want_ring = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+#endif
+    if (want_ring && uring_init(&ctx->ring, STATX_BATCH) == 0) {
+        ctx->statx_bufs = malloc(STATX_BATCH * sizeof(struct statx));
+        ctx->slot_entry = malloc(STATX_BATCH * sizeof(uint32_t));
+        if (!ctx->statx_bufs || !ctx->slot_entry) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
         }
+        ctx->has_ring = ctx->use_ring = 1;
+    }
+#endif
+}
+
+void scan_context_free(ScanContext *ctx) {
+    if (ctx->has_ring) uring_exit(&ctx->ring);
+    free(ctx->dirent_buf);
+    free(ctx->statx_bufs);
+    free(ctx->slot_entry);
+    free(ctx->render.out.data);
+}
+
+// statx 결과를 arena의 idx번째 항목에 옮긴다.
+static void fill_entry(EntryArena *arena, size_t idx, const struct statx *stx) {
+    arena->hot[idx].mode = stx->stx_mode;
+    if (arena->with_meta) {
+        EntryMeta *m = &arena->meta[idx];
+        m->mtime = stx->stx_mtime.tv_sec;
+        m->size = stx->stx_size;
+        m->nlink = stx->stx_nlink;
+        m->uid = stx->stx_uid;
+        m->gid = stx->stx_gid;
+    }
+}
+
+// stat에 실패한 항목 표시. 모든 stat이 끝난 뒤 arena_compact()가 제거한다.
+#define ENTRY_FAILED SIZE_MAX
+
+// 디렉터리 fd를 기준으로 항목 하나의 메타데이터를 가져와 arena의 idx번째 항목에 채운다.
+// 경로 문자열을 만들지 않으므로 커널이 전체 경로를 다시 탐색하지 않는다.
+int stat_entry(int dirfd, EntryArena *arena, size_t idx, unsigned int mask) {
+    struct statx stx;
+    if (statx(dirfd, entry_name(arena, idx), AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+              mask, &stx) == -1) {
+        return -1;
+    }
+    fill_entry(arena, idx, &stx);
+    return 0;
+}
+
+// 링에서 완료된 STATX 결과를 모두 거둬 arena에 반영한다. 처리한 개수를 돌려준다.
+static unsigned harvest_statx(ScanContext *ctx, int dirfd, EntryArena *arena, unsigned int mask,
+                              uint32_t *free_slots, unsigned *nfree) {
+    unsigned done = 0;
+    struct io_uring_cqe *cqe;
+    while ((cqe = uring_peek_cqe(&ctx->ring)) != NULL) {
+        uint32_t slot = (uint32_t)cqe->user_data;
+        size_t idx = ctx->slot_entry[slot];
+        int res = cqe->res;
+        uring_cqe_seen(&ctx->ring);
 
-        // 파일의 전체 경로를 생성 (예: "mydir/myfile.txt")
-        char fullpath[512];
-        snprintf(fullpath, sizeof(fullpath), "%s/%s", path, entry->d_name);
-        
-        // stat() 시스템 호출로 파일의 메타데이터를 가져와 files 배열에 저장
-        if (stat(fullpath, &files[count].st) == -1) {
+        if (res == 0) {
+            fill_entry(arena, idx, &ctx->statx_bufs[slot]);
+        } else if (res == -EINVAL || res == -EOPNOTSUPP) {
+            // 커널이 IORING_OP_STATX를 모르는 경우: 이 항목은 직접 처리하고 이후로는 링을 쓰지 않는다.
+            ctx->use_ring = 0;
+            if (stat_entry(dirfd, arena, idx, mask) == -1) {
+                perror("stat");
+                arena->hot[idx].name_off = ENTRY_FAILED;
+            }
+        } else {
+            errno = -res;
             perror("stat");
-            continue; // stat 실패 시 해당 파일은 건너뜀
+            arena->hot[idx].name_off = ENTRY_FAILED;
         }
-        
-        // 파일 이름만 구조체에 복사
-        strncpy(files[count].name, entry->d_name, sizeof(files[count].name) - 1);
-        files[count].name[sizeof(files[count].name) - 1] = '\0'; // 안전장치
+        free_slots[(*nfree)++] = slot;
+        done++;
+    }
+    return done;
+}
+
+// stat에 실패한 항목을 배열에서 제거한다. (names 버퍼의 빈 자리는 그대로 둔다)
+static void arena_compact(EntryArena *arena) {
+    size_t w = 0;
+    for (size_t r = 0; r < arena->count; r++) {
+        if (arena->hot[r].name_off == ENTRY_FAILED) continue;
+        arena->hot[w] = arena->hot[r];
+        if (arena->with_meta) arena->meta[w] = arena->meta[r];
+        w++;
+    }
+    arena->count = w;
+}
+
+/**
+ * 항목들의 메타데이터를 채운다.
+ * io_uring을 쓸 수 있으면 IORING_OP_STATX 요청을 STATX_BATCH개씩 링에 올려 두고
+ * 완료되는 대로 거둬들인다. 쓸 수 없으면 항목마다 statx를 직접 호출한다.
+ * mask가 0이면(-R에서 d_type을 모르는 경우) 종류를 모르는 항목만 STATX_TYPE으로 조회한다.
+ */
+void stat_entries(int dirfd, EntryArena *arena, unsigned int mask, ScanContext *ctx) {
+    unsigned int type_only = (mask == 0);
+    if (type_only) mask = STATX_TYPE;
+    int failed = 0;
 
-        count++; // 파일 개수 증가
+    uint32_t free_slots[STATX_BATCH];
+    unsigned nfree = 0, inflight = 0;
+    if (ctx->use_ring) {
+        for (uint32_t i = 0; i < STATX_BATCH; i++) free_slots[nfree++] = STATX_BATCH - 1 - i;
+    }
+
+    for (size_t idx = 0; idx < arena->count; idx++) {
+        if (type_only && arena->hot[idx].mode != 0) continue;
+
+        if (!ctx->use_ring) {
+            if (stat_entry(dirfd, arena, idx, mask) == -1) {
+                perror("stat");
+                arena->hot[idx].name_off = ENTRY_FAILED;
+                failed = 1;
+            }
+            continue;
+        }
+
+        // 빈 슬롯이 없으면 지금까지 쌓인 요청을 제출하고 하나 이상 끝나길 기다린다.
+        struct io_uring_sqe *sqe = NULL;
+        while (nfree == 0 || !(sqe = uring_get_sqe(&ctx->ring))) {
+            if (uring_submit(&ctx->ring, 1) == -1 && errno != EINTR) {
+                perror("io_uring_enter");
+                exit(EXIT_FAILURE);
+            }
+            inflight -= harvest_statx(ctx, dirfd, arena, mask, free_slots, &nfree);
+        }
+
+        uint32_t slot = free_slots[--nfree];
+        ctx->slot_entry[slot] = (uint32_t)idx;
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = dirfd;
+        sqe->addr = (uint64_t)(uintptr_t)entry_name(arena, idx);
+        sqe->len = mask;
+        sqe->off = (uint64_t)(uintptr_t)&ctx->statx_bufs[slot];
+        sqe->statx_flags = AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT;
+        sqe->user_data = slot;
+        inflight++;
+    }
+
+    // 남은 요청을 모두 제출하고 끝날 때까지 기다린다.
+    while (inflight > 0) {
+        if (uring_submit(&ctx->ring, 1) == -1 && errno != EINTR) {
+            perror("io_uring_enter");
+            exit(EXIT_FAILURE);
+        }
+        inflight -= harvest_statx(ctx, dirfd, arena, mask, free_slots, &nfree);
+    }
+
+    for (size_t idx = 0; idx < arena->count && !failed; idx++) {
+        if (arena->hot[idx].name_off == ENTRY_FAILED) failed = 1;
+    }
+    if (failed) arena_compact(arena);
+}
+
+// 디렉터리 하나를 읽어 arena에 항목을 채운다. (정렬은 sort_arena에서)
+// ctx는 호출자가 제공하는 스레드별 버퍼 (getdents64 버퍼, io_uring 링)
+void read_directory(int dirfd, const LsOptions *opts, EntryArena *arena, ScanContext *ctx) {
+    // -l/-t/-S처럼 메타데이터를 쓰는 옵션이 있을 때만 meta 배열을 유지한다.
+    arena_init(arena, (opts->statx_mask & ~STATX_TYPE) != 0);
+    int type_unknown = 0; // d_type을 모르는 항목이 있었는지
+
+    // getdents64로 한 번에 여러 항목을 읽어온다. 0을 돌려주면 디렉터리의 끝이다.
+    // 이름을 모두 모은 뒤 한꺼번에 stat 하므로, 여기서는 시스템 호출이 getdents64뿐이다.
+    long nread;
+    while ((nread = read_dirents(dirfd, ctx->dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *)(ctx->dirent_buf + off);
+            off += entry->d_reclen;
+
+            // -a 옵션이 없으면 '.'으로 시작하는 숨김 파일은 건너뛴다.
+            if (!opts->show_all && entry->d_name[0] == '.') {
+                continue;
+            }
+
+            // 메타데이터가 필요 없으면 d_type만으로 파일 종류를 채운다.
+            arena_add(arena, entry->d_name,
+                      (entry->d_type != DT_UNKNOWN) ? DTTOIF(entry->d_type) : 0);
+            if (entry->d_type == DT_UNKNOWN) type_unknown = 1;
+        }
+    }
+    if (nread == -1) {
+        perror("getdents64");
+    }
+
+    // 필요한 필드가 있거나, -R에서 파일 종류를 알 수 없을 때만 stat을 호출한다.
+    if (opts->statx_mask != 0 || (opts->recursive && type_unknown)) {
+        stat_entries(dirfd, arena, opts->statx_mask, ctx);
+    }
+}
+
+// 옵션에 맞게 arena의 출력 순서(order)를 정한다.
+void sort_arena(EntryArena *arena, const LsOptions *opts) {
+    // 정렬은 항목 자체가 아니라 4바이트 인덱스 배열에 대해서만 수행한다.
+    arena->order = malloc((arena->count ? arena->count : 1) * sizeof(uint32_t));
+    if (!arena->order) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < arena->count; i++) {
+        arena->order[i] = (uint32_t)i;
     }
-    closedir(dir); // 디렉터리 스트림을 닫는다. (자원 해제)
 
     // 정렬 옵션 처리
-    if (sort_time) { // -t 옵션: 시간순 정렬
-        qsort(files, count, sizeof(FileInfo), compare_mtime);
+    if (opts->sort_time) { // -t 옵션: 시간순 정렬
+        qsort_r(arena->order, arena->count, sizeof(uint32_t), compare_mtime, arena);
     } 
-    else if (sort_size) { // -S 옵션: 크기순 정렬
-        qsort(files, count, sizeof(FileInfo), compare_size);
+    else if (opts->sort_size) { // -S 옵션: 크기순 정렬
+        qsort_r(arena->order, arena->count, sizeof(uint32_t), compare_size, arena);
     }
     // (아무 옵션도 없으면 기본적으로 이름순으로 readdir이 읽은 순서대로 출력됨)
+}
 
-    // 실제 출력 부분
-    // -R 옵션 사용 시, 어느 디렉터리에 대한 출력인지 명시해준다.
-    if (recursive) {
-        printf("\n%s:\n", path);
+// --- --cache FILE: 디렉터리 목록 캐시 ---
+//
+// 디렉터리마다 (dev, ino, mtime, ctime)과 항목 목록(이름 + 종류)을 파일에 저장해 두고,
+// 다음 실행에서 디렉터리 자신의 statx 결과가 같으면 getdents64 없이 캐시에서 목록을 만든다.
+// 바뀐 디렉터리만 다시 읽는다.
+// 항목의 메타데이터(크기, 시간 등)는 캐시하지 않는다. 디렉터리의 mtime/ctime은 항목이
+// 추가/삭제/이름 변경될 때만 바뀌므로, 파일 내용만 바뀐 것은 디렉터리로는 알 수 없기 때문이다.
+// 메타데이터가 필요하면 항목마다 statx를 해야 해서 캐시로 아낄 것이 없으므로, --cache는
+// 이름만 나열할 때(-l/-t/-S 없이)만 받는다. 모든 디렉터리가 캐시와 같으면 캐시 파일을
+// 다시 쓰지 않는다.
+//
+// 파일 구조 (mmap으로 바로 읽을 수 있도록 고정 크기 레코드 배열):
+//   CacheHeader | CacheEntry[total_entries] | 이름 버퍼 | CacheDir[ndirs] ((dev, ino) 순 정렬)
+
+#define CACHE_MAGIC "CLSCACH2"
+#define CACHE_SHOW_ALL 0x1 // -a로 만든 목록 (숨김 파일 포함)
+
+typedef struct {
+    char magic[8];
+    uint32_t flags;             // CACHE_SHOW_ALL
+    uint32_t reserved;
+    uint64_t total_entries;
+    uint64_t names_off, names_len;
+    uint64_t dirs_off, ndirs;
+} CacheHeader;
+
+typedef struct {
+    uint64_t dev, ino;
+    int64_t mtime_sec, ctime_sec;
+    uint32_t mtime_nsec, ctime_nsec;
+    uint64_t first_entry;       // CacheEntry 배열에서의 시작 위치
+    uint64_t nentries;
+} CacheDir;
+
+typedef struct {
+    uint64_t name_off;          // 이름 버퍼 안에서의 위치 ('\0'으로 끝남)
+    uint32_t mode;              // 파일 종류 (d_type 또는 statx의 S_IFMT)
+    uint32_t reserved;
+} CacheEntry;
+
+struct LsCache {
+    // 이전 실행이 남긴 캐시 (읽기 전용 매핑, 없으면 NULL)
+    const char *old_map;
+    size_t old_size;
+    const CacheHeader *old_hdr;
+    const CacheDir *old_dirs;
+    const CacheEntry *old_entries;
+    const char *old_names;
+
+    // 이번 실행에서 새로 쓰는 캐시. 항목은 바로 파일에, 이름은 임시 파일에 이어 쓰고
+    // 디렉터리 목록만 메모리에 모았다가 끝에서 정렬해 붙인다.
+    char *path, *tmp_path;
+    FILE *out;
+    FILE *names_out;
+    CacheDir *dirs;
+    size_t ndirs, dirs_cap;
+    uint64_t total_entries, names_len;
+    uint64_t misses;            // 캐시에 없거나 바뀐 디렉터리 수 (0이면 새 캐시를 쓰지 않는다)
+    uint32_t flags;
+    pthread_mutex_t lock;       // -j에서 여러 작업 스레드가 동시에 기록
+};
+
+static int compare_cache_dir(const void *a, const void *b) {
+    const CacheDir *x = a, *y = b;
+    if (x->dev != y->dev) return x->dev < y->dev ? -1 : 1;
+    if (x->ino != y->ino) return x->ino < y->ino ? -1 : 1;
+    return 0;
+}
+
+// 기존 캐시 파일을 검증하고 매핑한다. 형식이 맞지 않으면 캐시가 없는 것처럼 동작한다.
+// 이름 버퍼는 '\0'으로 끝나야 한다. 그러면 버퍼 안의 어느 위치에서 strlen을 해도
+// 버퍼를 넘어가지 않으므로 항목마다는 name_off의 범위만 확인하면 된다.
+static void cache_map_old(LsCache *cache) {
+    int fd = open(cache->path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(CacheHeader)) {
+        char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            const CacheHeader *hdr = (const CacheHeader *)map;
+            size_t size = st.st_size;
+            uint64_t entries_end = sizeof(CacheHeader) + hdr->total_entries * sizeof(CacheEntry);
+            if (memcmp(hdr->magic, CACHE_MAGIC, 8) == 0 &&
+                hdr->flags == cache->flags &&
+                hdr->total_entries < size / sizeof(CacheEntry) &&
+                entries_end <= hdr->names_off &&
+                hdr->names_len <= size && hdr->dirs_off <= size &&
+                hdr->names_off + hdr->names_len <= hdr->dirs_off &&
+                (hdr->names_len == 0 || map[hdr->names_off + hdr->names_len - 1] == '\0') &&
+                hdr->ndirs <= size / sizeof(CacheDir) &&
+                hdr->dirs_off + hdr->ndirs * sizeof(CacheDir) <= size) {
+                cache->old_map = map;
+                cache->old_size = size;
+                cache->old_hdr = hdr;
+                cache->old_entries = (const CacheEntry *)(map + sizeof(CacheHeader));
+                cache->old_names = map + hdr->names_off;
+                cache->old_dirs = (const CacheDir *)(map + hdr->dirs_off);
+            } else {
+                munmap(map, size);
+            }
+        }
+    }
+    close(fd);
+}
+
+/**
+ * --cache FILE을 연다. 이전 캐시가 있으면 매핑하고, 새 캐시는 FILE.tmp에 쓰기 시작한다.
+ * 캐시는 -a 여부가 같은 실행끼리만 공유된다.
+ */
+LsCache *cache_open(const char *path, const LsOptions *opts) {
+    LsCache *cache = calloc(1, sizeof(LsCache));
+    if (!cache || !(cache->path = strdup(path)) || asprintf(&cache->tmp_path, "%s.tmp", path) == -1) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    cache->flags = opts->show_all ? CACHE_SHOW_ALL : 0;
+    pthread_mutex_init(&cache->lock, NULL);
+    cache_map_old(cache);
+
+    cache->out = fopen(cache->tmp_path, "w");
+    cache->names_out = tmpfile();
+    if (!cache->out || !cache->names_out) {
+        perror(cache->tmp_path);
+        exit(EXIT_FAILURE);
+    }
+    // 헤더 자리를 비워 두고 항목부터 쓴다. (헤더는 cache_close에서 채운다)
+    CacheHeader blank;
+    memset(&blank, 0, sizeof(blank));
+    fwrite(&blank, sizeof(blank), 1, cache->out);
+    return cache;
+}
+
+// 디렉터리 자신의 식별자와 변경 시각을 이미 열린 fd로 얻는다. (경로 탐색 없음)
+static int cache_dir_key(int dirfd, CacheDir *key) {
+    struct statx stx;
+    if (statx(dirfd, "", AT_EMPTY_PATH, STATX_INO | STATX_MTIME | STATX_CTIME, &stx) == -1) {
+        return -1;
+    }
+    memset(key, 0, sizeof(*key));
+    key->dev = ((uint64_t)stx.stx_dev_major << 32) | stx.stx_dev_minor;
+    key->ino = stx.stx_ino;
+    key->mtime_sec = stx.stx_mtime.tv_sec;
+    key->mtime_nsec = stx.stx_mtime.tv_nsec;
+    key->ctime_sec = stx.stx_ctime.tv_sec;
+    key->ctime_nsec = stx.stx_ctime.tv_nsec;
+    return 0;
+}
+
+// 이전 캐시에 같은 디렉터리가 바뀌지 않은 상태로 있으면 그 목록으로 arena를 채운다.
+static int cache_lookup(const LsCache *cache, const CacheDir *key, EntryArena *arena) {
+    if (!cache->old_map) return 0;
+    const CacheDir *hit = bsearch(key, cache->old_dirs, cache->old_hdr->ndirs,
+                                  sizeof(CacheDir), compare_cache_dir);
+    if (!hit || hit->mtime_sec != key->mtime_sec || hit->mtime_nsec != key->mtime_nsec ||
+        hit->ctime_sec != key->ctime_sec || hit->ctime_nsec != key->ctime_nsec ||
+        hit->first_entry + hit->nentries > cache->old_hdr->total_entries) {
+        return 0;
+    }
+
+    arena_init(arena, 0);
+    for (uint64_t i = 0; i < hit->nentries; i++) {
+        const CacheEntry *e = &cache->old_entries[hit->first_entry + i];
+        if (e->name_off >= cache->old_hdr->names_len) continue; // 손상된 항목
+        arena_add(arena, cache->old_names + e->name_off, e->mode);
+    }
+    return 1;
+}
+
+// 이번 실행에서 본 디렉터리 목록을 새 캐시에 기록한다. hit은 이전 캐시에서 가져온 목록인지.
+static void cache_record(LsCache *cache, const CacheDir *key, const EntryArena *arena, int hit) {
+    pthread_mutex_lock(&cache->lock);
+    if (!hit) cache->misses++;
+    cache->dirs = grow_array(cache->dirs, &cache->dirs_cap, cache->ndirs + 1, sizeof(CacheDir));
+    CacheDir *dir = &cache->dirs[cache->ndirs++];
+    *dir = *key;
+    dir->first_entry = cache->total_entries;
+    dir->nentries = arena->count;
+
+    for (size_t idx = 0; idx < arena->count; idx++) {
+        const char *name = entry_name(arena, idx);
+        size_t len = strlen(name) + 1;
+        CacheEntry e;
+        memset(&e, 0, sizeof(e));
+        e.name_off = cache->names_len;
+        e.mode = arena->hot[idx].mode & S_IFMT;
+        fwrite(&e, sizeof(e), 1, cache->out);
+        fwrite(name, 1, len, cache->names_out);
+        cache->names_len += len;
+    }
+    cache->total_entries += arena->count;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+// 새 캐시를 마무리하고 원래 이름으로 바꾼다. (rename이므로 중간에 끊겨도 이전 캐시는 온전함)
+static void cache_write(LsCache *cache) {
+    CacheHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CACHE_MAGIC, 8);
+    hdr.flags = cache->flags;
+    hdr.total_entries = cache->total_entries;
+    hdr.names_off = sizeof(CacheHeader) + cache->total_entries * sizeof(CacheEntry);
+    hdr.names_len = cache->names_len;
+    // 디렉터리 레코드가 8바이트 정렬되도록 이름 버퍼 뒤를 채운다.
+    hdr.dirs_off = (hdr.names_off + hdr.names_len + 7) & ~(uint64_t)7;
+    hdr.ndirs = cache->ndirs;
+
+    // 이름 버퍼를 항목 배열 뒤에 붙인다.
+    char buf[65536];
+    size_t n;
+    rewind(cache->names_out);
+    while ((n = fread(buf, 1, sizeof(buf), cache->names_out)) > 0) {
+        fwrite(buf, 1, n, cache->out);
     }
+    static const char pad[8];
+    fwrite(pad, 1, hdr.dirs_off - (hdr.names_off + hdr.names_len), cache->out);
+
+    qsort(cache->dirs, cache->ndirs, sizeof(CacheDir), compare_cache_dir);
+    fwrite(cache->dirs, sizeof(CacheDir), cache->ndirs, cache->out);
 
-    for (int i = 0; i < count; i++) {
-        if (long_format) { // -l 옵션: 긴 형식으로 출력
-            print_long_format(&files[i]);
-        } 
-        else { // 기본 출력
-            printf("%s\t", files[i].name);
+    rewind(cache->out);
+    fwrite(&hdr, sizeof(hdr), 1, cache->out);
+    if (fflush(cache->out) != 0 || ferror(cache->out)) {
+        perror(cache->tmp_path);
+        fclose(cache->out);
+        unlink(cache->tmp_path);
+    } else {
+        fclose(cache->out);
+        if (rename(cache->tmp_path, cache->path) == -1) {
+            perror(cache->path);
         }
     }
-    // -l 옵션이 아닐 때만 마지막에 줄바꿈을 추가해준다.
-    if (!long_format) {
-        printf("\n");
+}
+
+// 캐시를 닫는다. 모든 디렉터리가 이전 캐시와 같고 디렉터리 수도 같으면 새로 쓸 내용이
+// 이전 캐시와 같으므로, 쓰던 임시 파일을 버리고 이전 캐시를 그대로 둔다.
+void cache_close(LsCache *cache) {
+    if (cache->old_map && cache->misses == 0 && cache->ndirs == cache->old_hdr->ndirs) {
+        fclose(cache->out);
+        unlink(cache->tmp_path);
+    } else {
+        cache_write(cache);
+    }
+    fclose(cache->names_out);
+
+    if (cache->old_map) munmap((void *)cache->old_map, cache->old_size);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->dirs);
+    free(cache->path);
+    free(cache->tmp_path);
+    free(cache);
+}
+
+// 디렉터리 하나의 목록을 준비한다: 캐시에 바뀌지 않은 목록이 있으면 그것을 쓰고,
+// 없으면 읽어서 캐시에 기록한다. 마지막으로 옵션에 맞게 정렬한다.
+void load_directory(int dirfd, const LsOptions *opts, EntryArena *arena, ScanContext *ctx) {
+    CacheDir key;
+    int have_key = opts->cache && cache_dir_key(dirfd, &key) == 0;
+    int hit = have_key && cache_lookup(opts->cache, &key, arena);
+    if (!hit) {
+        read_directory(dirfd, opts, arena, ctx);
+    }
+    if (have_key) {
+        cache_record(opts->cache, &key, arena, hit);
+    }
+    sort_arena(arena, opts);
+}
+
+// 정렬된 arena의 내용을 렌더러 버퍼에 쓴다. (-R이면 디렉터리 제목 포함)
+void render_directory(Renderer *r, const char *path, const EntryArena *arena, const LsOptions *opts) {
+    // -R 옵션 사용 시, 어느 디렉터리에 대한 출력인지 명시해준다.
+    if (opts->recursive) {
+        out_char(&r->out, '\n');
+        out_write(&r->out, path, strlen(path));
+        out_write(&r->out, ":\n", 2);
+    }
+    render_entries(r, arena, arena->order, opts);
+    // 기본 형식일 때만 마지막에 줄바꿈을 추가해준다.
+    if (uses_tab_layout(opts)) {
+        out_char(&r->out, '\n');
     }
+}
+
+// -R에서 들어가야 할 하위 디렉터리인지 판단한다. ('.'과 '..' 제외)
+static int is_subdir(const EntryArena *arena, size_t idx) {
+    const char *name = entry_name(arena, idx);
+    return S_ISDIR(arena->hot[idx].mode) && !is_dot_or_dotdot(name);
+}
+
+// 핵심 로직: 특정 디렉터리의 내용을 목록으로 보여주는 함수
+// dirfd는 이미 열린 디렉터리이며, path는 출력(-R 제목, 오류 메시지)에만 사용한다.
+// 함수가 끝나면 dirfd를 닫는다.
+// ctx는 재귀 호출 간에 공유하는 작업 버퍼다.
+void list_directory(int dirfd, const char *path, const LsOptions *opts, ScanContext *ctx) {
+    EntryArena arena; // 디렉터리 항목들을 담을 저장소 (크기 제한 없음)
+    load_directory(dirfd, opts, &arena, ctx);
+    render_directory(&ctx->render, path, &arena, opts);
+    out_flush(&ctx->render.out, stdout);
 
     // -R (재귀) 옵션 처리
-    if (recursive) {
-        for (int i = 0; i < count; i++) {
+    if (opts->recursive) {
+        for (size_t i = 0; i < arena.count; i++) {
+            size_t idx = arena.order[i];
             // 현재 항목이 디렉터리이고, 자기 자신('.')이나 부모('..')가 아닐 경우
-            if (S_ISDIR(files[i].st.st_mode) &&
-                strcmp(files[i].name, ".") != 0 &&
-                strcmp(files[i].name, "..") != 0) {
-                
-                // 해당 하위 디렉터리에 대한 전체 경로 생성
-                char sub_path[512];
-                snprintf(sub_path, sizeof(sub_path), "%s/%s", path, files[i].name);
-                
-                // 자기 자신(list_directory 함수)을 다시 호출하여 재귀적으로 탐색
-                list_directory(sub_path, show_all, long_format, recursive, sort_time, sort_size);
+            if (!is_subdir(&arena, idx)) {
+                continue;
+            }
+            const char *name = entry_name(&arena, idx);
+
+            // 하위 디렉터리는 현재 디렉터리 fd를 기준으로 연다. (경로 재탐색 없음)
+            int subfd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (subfd == -1) {
+                perror("opendir");
+                continue;
+            }
+
+            // 제목 출력용 경로 생성
+            char *sub_path;
+            if (asprintf(&sub_path, "%s/%s", path, name) == -1) {
+                perror("asprintf");
+                close(subfd);
+                continue;
+            }
+
+            // 자기 자신(list_directory 함수)을 다시 호출하여 재귀적으로 탐색
+            list_directory(subfd, sub_path, opts, ctx);
+            free(sub_path);
+        }
+    }
+    arena_free(&arena);
+    close(dirfd);
+}
+
+// -U/-f 모드: 항목을 정렬하지 않고 getdents64가 돌려준 순서대로 바로 출력한다.
+// 디렉터리 전체를 메모리에 모으지 않고, getdents64 버퍼 하나 분량씩만 다루므로
+// 항목 수와 무관하게 메모리 사용량이 일정하고 첫 출력이 곧바로 나온다.
+// -l이면 버퍼 하나 분량의 항목을 stat_entries()로 한꺼번에 조회한 뒤 출력한다.
+void stream_directory(int dirfd, const char *path, const LsOptions *opts, ScanContext *ctx) {
+    EntryArena chunk;   // 현재 getdents64 버퍼의 항목들 (버퍼마다 재사용)
+    EntryArena subdirs; // -R에서 나중에 들어갈 하위 디렉터리 이름만 모아 둔다.
+    arena_init(&chunk, (opts->statx_mask & ~STATX_TYPE) != 0);
+    arena_init(&subdirs, 0);
+
+    if (opts->recursive) {
+        out_char(&ctx->render.out, '\n');
+        out_write(&ctx->render.out, path, strlen(path));
+        out_write(&ctx->render.out, ":\n", 2);
+    }
+
+    long nread;
+    while ((nread = read_dirents(dirfd, ctx->dirent_buf)) > 0) {
+        int type_unknown = 0;
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *)(ctx->dirent_buf + off);
+            off += entry->d_reclen;
+
+            if (!opts->show_all && entry->d_name[0] == '.') {
+                continue;
+            }
+            arena_add(&chunk, entry->d_name,
+                      (entry->d_type != DT_UNKNOWN) ? DTTOIF(entry->d_type) : 0);
+            if (entry->d_type == DT_UNKNOWN) type_unknown = 1;
+        }
+
+        if (opts->statx_mask != 0 || (opts->recursive && type_unknown)) {
+            stat_entries(dirfd, &chunk, opts->statx_mask, ctx);
+        }
+
+        // -l 열 너비와 -C 열 배치는 버퍼 하나 분량의 항목 안에서 정한다.
+        render_entries(&ctx->render, &chunk, NULL, opts);
+        if (opts->recursive) {
+            for (size_t idx = 0; idx < chunk.count; idx++) {
+                if (is_subdir(&chunk, idx)) {
+                    arena_add(&subdirs, entry_name(&chunk, idx), chunk.hot[idx].mode);
+                }
             }
         }
+        // 큰 디렉터리에서도 읽은 만큼은 바로 보이도록 버퍼 단위로 내보낸다.
+        out_flush(&ctx->render.out, stdout);
+        fflush(stdout);
+        arena_reset(&chunk);
+    }
+    if (nread == -1) {
+        perror("getdents64");
+    }
+    if (uses_tab_layout(opts)) {
+        out_char(&ctx->render.out, '\n');
+    }
+    out_flush(&ctx->render.out, stdout);
+    arena_free(&chunk);
+
+    // -R: 하위 디렉터리도 같은 방식으로 출력한다. (읽은 순서 그대로)
+    for (size_t idx = 0; idx < subdirs.count; idx++) {
+        const char *name = entry_name(&subdirs, idx);
+        int subfd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (subfd == -1) {
+            perror("opendir");
+            continue;
+        }
+        char *sub_path;
+        if (asprintf(&sub_path, "%s/%s", path, name) == -1) {
+            perror("asprintf");
+            close(subfd);
+            continue;
+        }
+        stream_directory(subfd, sub_path, opts, ctx);
+        free(sub_path);
     }
+    arena_free(&subdirs);
+    close(dirfd);
+}
+
+// --- -j N: 병렬 재귀 탐색 ---
+//
+// 디렉터리 하나가 작업 하나(DirNode)다. 작업 스레드는 디렉터리를 읽고 정렬해
+// 출력 블록을 메모리에 만든 뒤, 하위 디렉터리들을 자식 작업으로 자신의 덱에 넣는다.
+// 메인 스레드는 단일 스레드 버전과 같은 전위 순서로 트리를 따라가며
+// 완료된 블록을 차례로 출력한다. 아직 아무도 시작하지 않은 작업을 기다려야 하면
+// 메인 스레드가 직접 실행하므로, 작업 수 제한에 걸려도 멈추지 않는다.
+
+// 완료됐지만 아직 출력하지 못한 블록은 작업 스레드당 이 개수까지만 쌓이게 한다.
+#define PAR_PENDING_PER_WORKER 16
+
+enum { NODE_PENDING, NODE_RUNNING, NODE_DONE };
+
+typedef struct DirNode {
+    char *path;                 // 출력용 경로 (디렉터리를 여는 데는 쓰지 않음)
+    const char *name;           // 부모 디렉터리 기준 이름 (path의 마지막 구성요소)
+    SharedFd *parent_fd;        // openat 기준 fd (루트는 NULL)
+    int fd;                     // 루트 작업에서만 미리 열린 fd
+    atomic_int state;           // NODE_PENDING / RUNNING / DONE
+    atomic_int refs;            // 트리(출력 스레드)와 덱이 각각 하나씩 가진다
+    char *out;                  // 완료된 출력 블록
+    size_t out_len;
+    struct DirNode **children;  // 출력 순서대로 정렬된 하위 디렉터리 작업
+    size_t nchildren;
+} DirNode;
+
+typedef struct {
+    const LsOptions *opts;
+    WorkDeque *deques;          // 작업 스레드마다 하나 + 메인 스레드용 하나
+    int ndeques;
+    atomic_int inflight;        // 실행 중이거나 완료됐지만 출력되지 않은 작업 수
+    int max_inflight;
+    pthread_mutex_t lock;       // 아래 조건 변수용
+    pthread_cond_t changed;     // 작업 추가/완료/출력 시 알림
+    unsigned long epoch;        // 알림 누락을 막기 위한 변경 카운터
+    int shutdown;
+} WorkPool;
+
+typedef struct {
+    WorkPool *pool;
+    int index;                  // 자신의 덱 번호
+} WorkerArg;
+
+static void node_unref(DirNode *node) {
+    if (atomic_fetch_sub(&node->refs, 1) == 1) {
+        free(node->path);
+        free(node->out);
+        free(node->children);
+        free(node);
+    }
+}
+
+static void pool_notify(WorkPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch++;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// 디렉터리 하나를 처리한다: 열기, 읽기, 정렬, 출력 블록 생성, 자식 작업 등록
+static void run_node(WorkPool *pool, DirNode *node, int deque_index, ScanContext *ctx) {
+    const LsOptions *opts = pool->opts;
+    int dirfd = node->fd;
+
+    if (node->parent_fd) {
+        dirfd = openat(node->parent_fd->fd, node->name,
+                       O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        shared_fd_unref(node->parent_fd);
+        node->parent_fd = NULL;
+        if (dirfd == -1) {
+            perror("opendir");
+        }
+    }
+
+    if (dirfd != -1) {
+        EntryArena arena;
+        load_directory(dirfd, opts, &arena, ctx);
+
+        // 렌더러 버퍼를 그대로 출력 블록으로 넘긴다. (복사 없음)
+        render_directory(&ctx->render, node->path, &arena, opts);
+        node->out = ctx->render.out.data;
+        node->out_len = ctx->render.out.len;
+        memset(&ctx->render.out, 0, sizeof(ctx->render.out));
+
+        size_t nsub = 0;
+        for (size_t i = 0; i < arena.count; i++) {
+            if (is_subdir(&arena, arena.order[i])) nsub++;
+        }
+
+        if (nsub > 0) {
+            SharedFd *sfd = shared_fd_new(dirfd, (int)nsub);
+            node->children = malloc(nsub * sizeof(DirNode *));
+            if (!node->children) {
+                perror("malloc");
+                exit(EXIT_FAILURE);
+            }
+
+            for (size_t i = 0; i < arena.count; i++) {
+                size_t idx = arena.order[i];
+                if (!is_subdir(&arena, idx)) continue;
+
+                DirNode *child = calloc(1, sizeof(DirNode));
+                if (!child || asprintf(&child->path, "%s/%s", node->path, entry_name(&arena, idx)) == -1) {
+                    perror("malloc");
+                    exit(EXIT_FAILURE);
+                }
+                child->name = child->path + strlen(node->path) + 1;
+                child->parent_fd = sfd;
+                child->fd = -1;
+                atomic_init(&child->state, NODE_PENDING);
+                atomic_init(&child->refs, 2); // 트리 + 덱
+                node->children[node->nchildren++] = child;
+            }
+            // 첫 번째 자식이 덱의 맨 뒤에 오도록 역순으로 넣는다. (주인은 뒤에서 꺼냄)
+            for (size_t i = nsub; i-- > 0; ) {
+                deque_push(&pool->deques[deque_index], node->children[i]);
+            }
+        } else {
+            close(dirfd);
+        }
+        arena_free(&arena);
+    }
+
+    atomic_store(&node->state, NODE_DONE);
+    pool_notify(pool);
+}
+
+// 아직 아무도 시작하지 않은 작업이면 실행 권한을 가져온다.
+static int claim_node(DirNode *node) {
+    int expected = NODE_PENDING;
+    return atomic_compare_exchange_strong(&node->state, &expected, NODE_RUNNING);
+}
+
+// 자신의 덱에서 먼저 꺼내고, 비어 있으면 다른 덱에서 훔친다.
+static DirNode *find_work(WorkPool *pool, int index) {
+    DirNode *node = deque_pop(&pool->deques[index], 0);
+    for (int i = 1; !node && i < pool->ndeques; i++) {
+        node = deque_pop(&pool->deques[(index + i) % pool->ndeques], 1);
+    }
+    return node;
+}
+
+static void *worker_main(void *p) {
+    WorkerArg *arg = p;
+    WorkPool *pool = arg->pool;
+    ScanContext ctx; // 스레드마다 자신의 getdents64 버퍼와 io_uring 링을 쓴다.
+    scan_context_init(&ctx);
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        unsigned long seen = pool->epoch;
+        int stop = pool->shutdown;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+
+        DirNode *node = NULL;
+        // 출력되지 않은 블록이 너무 많이 쌓였으면 새 작업을 시작하지 않는다.
+        if (atomic_fetch_add(&pool->inflight, 1) < pool->max_inflight) {
+            node = find_work(pool, arg->index);
+            if (node && !claim_node(node)) {
+                node_unref(node); // 이미 메인 스레드가 가져간 작업
+                node = NULL;
+            }
+        }
+
+        if (node) {
+            run_node(pool, node, arg->index, &ctx);
+            node_unref(node);
+            continue;
+        }
+        atomic_fetch_sub(&pool->inflight, 1);
+
+        // 할 일이 없거나 한도에 걸렸으면 상태가 바뀔 때까지 기다린다.
+        pthread_mutex_lock(&pool->lock);
+        while (pool->epoch == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    scan_context_free(&ctx);
+    return NULL;
+}
+
+// -j N 버전의 list_directory. 출력 순서는 단일 스레드 버전과 같다.
+void list_directory_parallel(int dirfd, const char *path, const LsOptions *opts, ScanContext *ctx) {
+    WorkPool pool = {0};
+    pool.opts = opts;
+    pool.ndeques = opts->jobs + 1; // 마지막 덱은 메인 스레드용
+    pool.max_inflight = opts->jobs * PAR_PENDING_PER_WORKER;
+    pool.deques = calloc(pool.ndeques, sizeof(WorkDeque));
+    pthread_t *threads = calloc(opts->jobs, sizeof(pthread_t));
+    WorkerArg *args = calloc(opts->jobs, sizeof(WorkerArg));
+    DirNode **stack = NULL; // 출력 순서를 따라가기 위한 명시적 스택
+    size_t stack_len = 0, stack_cap = 0;
+    if (!pool.deques || !threads || !args) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    for (int i = 0; i < pool.ndeques; i++) {
+        deque_init(&pool.deques[i]);
+    }
+
+    DirNode *root = calloc(1, sizeof(DirNode));
+    if (!root || !(root->path = strdup(path))) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    root->fd = dirfd;
+    atomic_init(&root->state, NODE_PENDING);
+    atomic_init(&root->refs, 1); // 덱에 넣지 않으므로 트리 참조만
+
+    for (int i = 0; i < opts->jobs; i++) {
+        args[i].pool = &pool;
+        args[i].index = i;
+        if (pthread_create(&threads[i], NULL, worker_main, &args[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    stack = grow_array(stack, &stack_cap, 1, sizeof(DirNode *));
+    stack[stack_len++] = root;
+    while (stack_len > 0) {
+        DirNode *node = stack[--stack_len];
+
+        // 이 디렉터리가 끝날 때까지 기다린다. 아무도 시작하지 않았으면 직접 실행한다.
+        pthread_mutex_lock(&pool.lock);
+        while (atomic_load(&node->state) != NODE_DONE) {
+            if (claim_node(node)) {
+                pthread_mutex_unlock(&pool.lock);
+                atomic_fetch_add(&pool.inflight, 1);
+                run_node(&pool, node, pool.ndeques - 1, ctx);
+                pthread_mutex_lock(&pool.lock);
+                continue;
+            }
+            pthread_cond_wait(&pool.changed, &pool.lock);
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        fwrite(node->out, 1, node->out_len, stdout);
+        atomic_fetch_sub(&pool.inflight, 1);
+        pool_notify(&pool); // 한도에 걸려 기다리던 작업 스레드를 깨운다.
+
+        // 자식은 첫 번째가 먼저 나오도록 역순으로 쌓는다.
+        stack = grow_array(stack, &stack_cap, stack_len + node->nchildren, sizeof(DirNode *));
+        for (size_t i = node->nchildren; i-- > 0; ) {
+            stack[stack_len++] = node->children[i];
+        }
+        node_unref(node);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.changed);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < opts->jobs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 0; i < pool.ndeques; i++) {
+        // 메인 스레드가 먼저 실행한 작업이 덱에 남아 있을 수 있다.
+        DirNode *left;
+        while ((left = deque_pop(&pool.deques[i], 0)) != NULL) {
+            node_unref(left);
+        }
+        deque_destroy(&pool.deques[i]);
+    }
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.deques);
+    free(threads);
+    free(args);
+    free(stack);
 }
 
 int main(int argc, char *argv[]) {
-    // 옵션 상태를 저장할 플래그 변수 초기화
-    int show_all = 0, long_format = 0, recursive = 0;
-    int sort_time = 0, sort_size = 0;
+    // 옵션 상태를 저장할 구조체 초기화
+    LsOptions opts = {0};
     int opt;
+    const char *cache_path = NULL;
+    int layout_given = 0; // -C나 -1을 직접 지정했는지
 
-    // getopt를 사용하여 명령줄 옵션을 파싱
-    // "alRtS"는 -a, -l, -R, -t, -S 옵션을 허용한다는 의미
-    while ((opt = getopt(argc, argv, "alRtS")) != -1) {
+    static const struct option long_opts[] = {
+        {"cache", required_argument, NULL, 'c'},
+        {NULL, 0, NULL, 0}
+    };
+
+    // getopt_long을 사용하여 명령줄 옵션을 파싱
+    // "alRtSUfC1w:j:"는 -a, -l, -R, -t, -S, -U, -f, -C, -1, -w N, -j N 옵션을 허용한다는 의미
+    while ((opt = getopt_long(argc, argv, "alRtSUfC1w:j:", long_opts, NULL)) != -1) {
         switch (opt) {
-            case 'a': show_all = 1; break;
-            case 'l': long_format = 1; break;
-            case 'R': recursive = 1; break;
-            case 't': sort_time = 1; sort_size = 0; break; // t와 S는 동시에 적용될 수 없으므로 다른 쪽을 해제
-            case 'S': sort_size = 1; sort_time = 0; break;
+            case 'a': opts.show_all = 1; break;
+            case 'l': opts.long_format = 1; break;
+            case 'R': opts.recursive = 1; break;
+            case 't': opts.sort_time = 1; opts.sort_size = 0; break; // t와 S는 동시에 적용될 수 없으므로 다른 쪽을 해제
+            case 'S': opts.sort_size = 1; opts.sort_time = 0; break;
+            case 'U': opts.unsorted = 1; break;
+            case 'f': opts.unsorted = 1; opts.show_all = 1; break; // -f는 -aU와 같다
+            case 'C': opts.columns = 1; opts.one_per_line = 0; layout_given = 1; break;
+            case '1': opts.one_per_line = 1; opts.columns = 0; layout_given = 1; break;
+            case 'w':
+                opts.line_width = (size_t)atol(optarg);
+                if (opts.line_width < 1) {
+                    fprintf(stderr, "ls: invalid line width: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                if (opts.jobs < 1) {
+                    fprintf(stderr, "ls: invalid number of jobs: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'c': cache_path = optarg; break;
             default: // 인식할 수 없는 옵션일 경우
-                fprintf(stderr, "사용법: %s [-a] [-l] [-R] [-t] [-S] [파일 또는 디렉터리]\n", argv[0]);
+                fprintf(stderr, "사용법: %s [-a] [-l] [-R] [-t] [-S] [-U] [-f] [-C] [-1] [-w N] [-j N] [--cache FILE] [파일 또는 디렉터리]\n", argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
@@ -188,8 +1431,61 @@ int main(int argc, char *argv[]) {
         target_path = argv[optind];
     }
 
-    // 핵심 로직 함수 호출
-    list_directory(target_path, show_all, long_format, recursive, sort_time, sort_size);
+    // -U/-f는 정렬하지 않으므로 -t/-S를 무시한다.
+    if (opts.unsorted) {
+        opts.sort_time = opts.sort_size = 0;
+    }
+    opts.statx_mask = compute_statx_mask(&opts);
+    // --cache는 이름과 종류만 저장하므로, 항목의 메타데이터가 필요한 옵션과는 함께 쓸 수 없다.
+    if (cache_path && (opts.statx_mask & ~STATX_TYPE) != 0) {
+        fprintf(stderr, "%s: --cache는 이름만 나열할 때만 쓸 수 있습니다 (-l, -t, -S와 함께 쓸 수 없음)\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    // -l은 항목마다 소유자/그룹 이름이 필요하므로 /etc/passwd, /etc/group을 미리 읽어 둔다.
+    if (opts.long_format) {
+        idcache_warm();
+    }
+
+    // GNU ls처럼 터미널에 출력할 때는 기본으로 여러 열을 쓴다.
+    if (!layout_given && isatty(STDOUT_FILENO)) {
+        opts.columns = 1;
+    }
+    if (opts.columns && opts.line_width == 0) {
+        struct winsize ws;
+        const char *env = getenv("COLUMNS");
+        opts.line_width = 80;
+        if (env && atol(env) > 0) opts.line_width = (size_t)atol(env);
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) opts.line_width = ws.ws_col;
+    }
+
+    int dirfd = open(target_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd == -1) {
+        perror("opendir");
+        return EXIT_FAILURE;
+    }
+
+    ScanContext ctx;
+    scan_context_init(&ctx);
+
+    // --cache는 목록 전체를 만드는 정렬 모드에서만 쓴다. (-U는 항목을 모으지 않음)
+    if (cache_path && !opts.unsorted) {
+        opts.cache = cache_open(cache_path, &opts);
+    }
+
+    // 핵심 로직 함수 호출 (-j는 -R에서만 의미가 있다)
+    if (opts.unsorted) {
+        static char out_buf[STREAM_OUT_BUF_SIZE];
+        setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+        stream_directory(dirfd, target_path, &opts, &ctx);
+    } else if (opts.recursive && opts.jobs > 0) {
+        list_directory_parallel(dirfd, target_path, &opts, &ctx);
+    } else {
+        list_directory(dirfd, target_path, &opts, &ctx);
+    }
+    if (opts.cache) {
+        cache_close(opts.cache);
+    }
+    scan_context_free(&ctx);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,448 @@
+#define _GNU_SOURCE     // for memrchr, syscall
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>     // getpid, syscall
+#include <fcntl.h>      // open (/proc)
+#include <errno.h>
+#include <ctype.h>      // isdigit, isupper (신호 인자 구분)
+#include <signal.h>     // SIGTERM 등 신호 번호
+#include <regex.h>      // regcomp, regexec (확장 정규식)
+#include <pwd.h>        // getpwnam (-u 사용자 이름)
+#include <getopt.h>     // getopt_long (--signal)
+#include <sys/stat.h>   // fstatat (프로세스 소유자 확인)
+#include <sys/syscall.h> // SYS_pidfd_open, SYS_pidfd_send_signal
+#include "c_walk.h"     // getdents64로 /proc 읽기 (c_ls, c_du와 공유)
+#include "c_proc.h"     // /proc 읽기와 stat 해석 (c_ps와 공유)
+
+// c_pgrep / c_pkill: 조건에 맞는 프로세스를 찾아 pid를 출력하거나(c_pgrep) 신호를 보낸다(c_pkill).
+// c_pkill.c는 PGREP_DEFAULT_KILL을 1로 정의하고 이 파일을 포함한다.
+//
+// 'ps -ef | grep'은 프로세스 세 개를 띄우고 모든 프로세스의 모든 정보를 글자로 만든 뒤
+// 다시 grep으로 걸러낸다. 여기서는 /proc을 한 번 훑으며 싼 조건부터 확인한다.
+//  1. -u: /proc/<pid> 디렉터리의 stat 한 번 (소유자 = 유효 UID)
+//  2. -P, 이름 패턴, -n/-o: /proc/<pid>/stat 한 번 (ppid, comm, starttime)
+//  3. -f, -a: 앞의 조건을 모두 통과한 프로세스만 /proc/<pid>/cmdline을 읽는다.
+//
+// 신호는 pidfd로 보낸다. 찾은 뒤 신호를 보내기 전에 그 프로세스가 끝나고 pid가 다른
+// 프로세스에 재사용되면 kill(pid)은 엉뚱한 프로세스를 죽인다. pidfd_open으로 pid를 붙잡은 뒤
+// starttime이 찾을 때와 같은지 확인하고 pidfd_send_signal로 보내면, 신호는 찾은 그
+// 프로세스에만 가거나(이미 끝났으면) 아무에게도 가지 않는다.
+
+#ifndef PGREP_DEFAULT_KILL
+#define PGREP_DEFAULT_KILL 0
+#endif
+
+// 오래된 헤더에는 pidfd 시스템 호출 번호가 없다. (번호는 모든 아키텍처에서 같다)
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+// pgrep과 같은 종료 코드
+#define EXIT_MATCHED 0
+#define EXIT_NO_MATCH 1
+#define EXIT_USAGE 2
+#define EXIT_FATAL 3
+
+typedef struct {
+    int kill_mode;          // c_pkill: 찾은 프로세스에 신호를 보낸다
+    int signo;              // -SIGNAL, --signal (기본 SIGTERM)
+    int full;               // -f: 이름 대신 전체 명령줄에 패턴을 맞춘다
+    int exact;              // -x: 패턴이 전체와 일치해야 한다
+    int ignore_case;        // -i
+    int newest;             // -n: 가장 최근에 시작한 것 하나
+    int oldest;             // -o: 가장 먼저 시작한 것 하나
+    int count;              // -c: 개수만 출력
+    int list_name;          // -l: pid와 이름 출력 (c_pgrep)
+    int list_full;          // -a: pid와 전체 명령줄 출력 (c_pgrep)
+    int echo;               // -e: 신호를 보낸 프로세스 출력 (c_pkill)
+    const char *delim;      // -d: pid 사이 구분자 (c_pgrep)
+    uid_t *uids;            // -u: 유효 UID 목록
+    size_t nuids;
+    int *ppids;             // -P: 부모 pid 목록
+    size_t nppids;
+    int has_pattern;
+    regex_t pattern;
+} PgrepOptions;
+
+// 조건에 맞은 프로세스
+typedef struct {
+    int pid;
+    unsigned long long starttime;   // 신호를 보내기 전에 같은 프로세스인지 확인한다
+    char *text;                     // -l/-a/-e로 출력할 이름 또는 명령줄 (필요할 때만)
+} Match;
+
+// 함수 선언
+int parse_signal(const char *name);
+void parse_user_list(PgrepOptions *opts, char *list);
+void parse_ppid_list(PgrepOptions *opts, char *list);
+int match_process(const PgrepOptions *opts, int proc_fd, int pid, ProcBuf *buf, Match *m);
+int signal_process(const Match *m, int signo, int proc_fd, ProcBuf *buf);
+
+static void usage(const char *prog, int kill_mode) {
+    if (kill_mode) {
+        fprintf(stderr, "사용법: %s [-SIGNAL | --signal SIGNAL] [-f] [-x] [-i] [-n|-o] [-c] [-e] "
+                        "[-u USER,...] [-P PPID,...] [PATTERN]\n", prog);
+    } else {
+        fprintf(stderr, "사용법: %s [-f] [-x] [-i] [-n|-o] [-c] [-l|-a] [-d DELIM] "
+                        "[-u USER,...] [-P PPID,...] [PATTERN]\n", prog);
+    }
+    exit(EXIT_USAGE);
+}
+
+// 메인 함수
+int main(int argc, char *argv[]) {
+    PgrepOptions opts = {0};
+    opts.signo = SIGTERM;
+    opts.delim = "\n";
+
+    // 실행 파일 이름이 pkill로 끝나면 c_pgrep을 링크해 쓴 경우에도 신호 모드로 동작한다.
+    const char *prog = strrchr(argv[0], '/') ? strrchr(argv[0], '/') + 1 : argv[0];
+    size_t prog_len = strlen(prog);
+    opts.kill_mode = PGREP_DEFAULT_KILL || (prog_len >= 5 && strcmp(prog + prog_len - 5, "pkill") == 0);
+
+    // pkill -9, pkill -KILL, pkill -SIGKILL: 신호 인자는 getopt보다 먼저 꺼낸다.
+    // 옵션 묶음(-io 등)과 헷갈리지 않도록 숫자나 대문자로 시작하는 것만 신호로 본다.
+    if (opts.kill_mode) {
+        int kept = 1, options_done = 0;
+        for (int i = 1; i < argc; i++) {
+            const char *arg = argv[i];
+            int signo = -1;
+            if (strcmp(arg, "--") == 0) {
+                options_done = 1;
+            } else if (!options_done && arg[0] == '-' && (isdigit((unsigned char)arg[1]) || isupper((unsigned char)arg[1]))) {
+                signo = parse_signal(arg + 1);
+            }
+            if (signo > 0) {
+                opts.signo = signo;
+            } else {
+                argv[kept++] = argv[i];
+            }
+        }
+        argc = kept;
+        argv[argc] = NULL;
+    }
+
+    static const struct option long_opts[] = {
+        {"signal", required_argument, NULL, 'S'},
+        {NULL, 0, NULL, 0}
+    };
+    const char *optstring = opts.kill_mode ? "fxinoceu:P:" : "fxinoclad:u:P:";
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, optstring, long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'f': opts.full = 1; break;
+            case 'x': opts.exact = 1; break;
+            case 'i': opts.ignore_case = 1; break;
+            case 'n': opts.newest = 1; break;
+            case 'o': opts.oldest = 1; break;
+            case 'c': opts.count = 1; break;
+            case 'l': opts.list_name = 1; break;
+            case 'a': opts.list_full = 1; break;
+            case 'e': opts.echo = 1; break;
+            case 'd': opts.delim = optarg; break;
+            case 'u': parse_user_list(&opts, optarg); break;
+            case 'P': parse_ppid_list(&opts, optarg); break;
+            case 'S':
+                opts.signo = parse_signal(optarg);
+                if (opts.signo <= 0) {
+                    fprintf(stderr, "%s: unknown signal: %s\n", prog, optarg);
+                    exit(EXIT_USAGE);
+                }
+                break;
+            default:
+                usage(prog, opts.kill_mode);
+        }
+    }
+    if (opts.newest && opts.oldest) {
+        fprintf(stderr, "%s: -n and -o cannot be used together\n", prog);
+        exit(EXIT_USAGE);
+    }
+    if (optind + 1 < argc) {
+        fprintf(stderr, "%s: only one pattern can be provided\n", prog);
+        usage(prog, opts.kill_mode);
+    }
+
+    if (optind < argc) {
+        // -x는 패턴 전체를 묶어 앞뒤를 고정한다.
+        const char *pat = argv[optind];
+        char *anchored = NULL;
+        if (opts.exact && asprintf(&anchored, "^(%s)$", pat) == -1) {
+            perror("asprintf");
+            exit(EXIT_FATAL);
+        }
+        int flags = REG_EXTENDED | REG_NOSUB | (opts.ignore_case ? REG_ICASE : 0);
+        int err = regcomp(&opts.pattern, anchored ? anchored : pat, flags);
+        free(anchored);
+        if (err != 0) {
+            char msg[256];
+            regerror(err, &opts.pattern, msg, sizeof(msg));
+            fprintf(stderr, "%s: invalid pattern: %s\n", prog, msg);
+            exit(EXIT_USAGE);
+        }
+        opts.has_pattern = 1;
+    } else if (opts.nuids == 0 && opts.nppids == 0) {
+        fprintf(stderr, "%s: no matching criteria specified\n", prog);
+        usage(prog, opts.kill_mode);
+    }
+
+    int proc_fd = open(PROC_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    char *dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (proc_fd == -1) {
+        perror("open /proc");
+        exit(EXIT_FATAL);
+    }
+    if (!dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FATAL);
+    }
+
+    size_t npids;
+    int *pids = proc_list_pids(proc_fd, dirent_buf, &npids);
+    int self = getpid();
+    ProcBuf buf = {0}; // 모든 프로세스가 함께 쓰는 읽기 버퍼
+
+    Match *matches = NULL;
+    size_t nmatches = 0, matches_cap = 0;
+    for (size_t i = 0; i < npids; i++) {
+        if (pids[i] == self) continue; // 자기 자신은 빼낸다.
+        Match m;
+        if (!match_process(&opts, proc_fd, pids[i], &buf, &m)) continue;
+
+        // -n/-o: 지금까지 고른 것보다 늦게(일찍) 시작했으면 바꾼다. 같으면 pid로 가른다.
+        if ((opts.newest || opts.oldest) && nmatches == 1) {
+            int later = m.starttime > matches[0].starttime ||
+                        (m.starttime == matches[0].starttime && m.pid > matches[0].pid);
+            if (later == opts.newest) {
+                free(matches[0].text);
+                matches[0] = m;
+            } else {
+                free(m.text);
+            }
+            continue;
+        }
+        matches = grow_array(matches, &matches_cap, nmatches + 1, sizeof(Match));
+        matches[nmatches++] = m;
+    }
+
+    size_t done = 0; // 출력했거나 신호를 보낸 수
+    int failed = 0;
+    for (size_t i = 0; i < nmatches; i++) {
+        const Match *m = &matches[i];
+        if (opts.kill_mode) {
+            int ret = signal_process(m, opts.signo, proc_fd, &buf);
+            if (ret == -1) {
+                failed = 1;
+            } else if (ret == 1) {
+                done++;
+                if (opts.echo) printf("%s killed (pid %d)\n", m->text, m->pid);
+            }
+        } else {
+            done++;
+            if (opts.count) continue;
+            if (done > 1) fputs(opts.delim, stdout);
+            if (m->text) printf("%d %s", m->pid, m->text);
+            else printf("%d", m->pid);
+        }
+    }
+    if (!opts.kill_mode && !opts.count && done > 0) {
+        putchar('\n'); // 구분자를 바꿔도 마지막 줄은 끝낸다.
+    }
+    if (opts.count) {
+        printf("%zu\n", done);
+    }
+
+    for (size_t i = 0; i < nmatches; i++) free(matches[i].text);
+    free(matches);
+    free(buf.data);
+    free(pids);
+    free(dirent_buf);
+    close(proc_fd);
+    if (opts.has_pattern) regfree(&opts.pattern);
+
+    if (failed && done == 0) return EXIT_FATAL;
+    return done > 0 ? EXIT_MATCHED : EXIT_NO_MATCH;
+}
+
+/**
+ * @brief 신호 이름이나 번호를 신호 번호로 바꾼다. ("9", "KILL", "SIGKILL", "kill")
+ * @return 신호 번호, 알 수 없으면 -1
+ */
+int parse_signal(const char *name) {
+    static const struct { const char *name; int signo; } signals[] = {
+        {"HUP", SIGHUP}, {"INT", SIGINT}, {"QUIT", SIGQUIT}, {"ILL", SIGILL},
+        {"TRAP", SIGTRAP}, {"ABRT", SIGABRT}, {"BUS", SIGBUS}, {"FPE", SIGFPE},
+        {"KILL", SIGKILL}, {"USR1", SIGUSR1}, {"SEGV", SIGSEGV}, {"USR2", SIGUSR2},
+        {"PIPE", SIGPIPE}, {"ALRM", SIGALRM}, {"TERM", SIGTERM}, {"CHLD", SIGCHLD},
+        {"CONT", SIGCONT}, {"STOP", SIGSTOP}, {"TSTP", SIGTSTP}, {"TTIN", SIGTTIN},
+        {"TTOU", SIGTTOU}, {"URG", SIGURG}, {"XCPU", SIGXCPU}, {"XFSZ", SIGXFSZ},
+        {"VTALRM", SIGVTALRM}, {"PROF", SIGPROF}, {"WINCH", SIGWINCH}, {"IO", SIGIO},
+        {"PWR", SIGPWR}, {"SYS", SIGSYS},
+    };
+
+    if (*name >= '0' && *name <= '9') {
+        char *end;
+        long signo = strtol(name, &end, 10);
+        return (*end == '\0' && signo > 0 && signo < NSIG) ? (int)signo : -1;
+    }
+    if (strncasecmp(name, "SIG", 3) == 0) {
+        name += 3;
+    }
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        if (strcasecmp(name, signals[i].name) == 0) return signals[i].signo;
+    }
+    return -1;
+}
+
+/**
+ * @brief -u 인자("root,1000")를 UID 목록에 더한다. 이름과 숫자 모두 받는다.
+ */
+void parse_user_list(PgrepOptions *opts, char *list) {
+    size_t cap = opts->nuids;
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        uid_t uid;
+        struct passwd *pw = getpwnam(name);
+        char *end;
+        if (pw) {
+            uid = pw->pw_uid;
+        } else {
+            unsigned long v = strtoul(name, &end, 10);
+            if (*name == '\0' || *end != '\0') {
+                fprintf(stderr, "pgrep: invalid user name: %s\n", name);
+                exit(EXIT_USAGE);
+            }
+            uid = (uid_t)v;
+        }
+        opts->uids = grow_array(opts->uids, &cap, opts->nuids + 1, sizeof(uid_t));
+        opts->uids[opts->nuids++] = uid;
+    }
+}
+
+/**
+ * @brief -P 인자("1,200")를 부모 pid 목록에 더한다.
+ */
+void parse_ppid_list(PgrepOptions *opts, char *list) {
+    size_t cap = opts->nppids;
+    for (char *item = strtok(list, ","); item; item = strtok(NULL, ",")) {
+        char *end;
+        long ppid = strtol(item, &end, 10);
+        if (*item == '\0' || *end != '\0' || ppid < 0) {
+            fprintf(stderr, "pgrep: invalid parent pid: %s\n", item);
+            exit(EXIT_USAGE);
+        }
+        opts->ppids = grow_array(opts->ppids, &cap, opts->nppids + 1, sizeof(int));
+        opts->ppids[opts->nppids++] = (int)ppid;
+    }
+}
+
+/**
+ * @brief pid 하나가 모든 조건에 맞는지 확인한다. 싼 조건부터 보고, 하나라도 틀리면 바로 그만둔다.
+ * @param m 맞으면 채울 결과 (m->text는 호출자가 free)
+ * @return 맞으면 1, 아니면(또는 그 사이 끝났으면) 0
+ */
+int match_process(const PgrepOptions *opts, int proc_fd, int pid, ProcBuf *buf, Match *m) {
+    char pid_name[16], path[64];
+    snprintf(pid_name, sizeof(pid_name), "%d", pid);
+
+    // 1. -u: 파일을 읽지 않고 디렉터리 소유자만 본다.
+    if (opts->nuids > 0) {
+        struct stat st;
+        if (fstatat(proc_fd, pid_name, &st, 0) == -1) {
+            return 0;
+        }
+        size_t i = 0;
+        while (i < opts->nuids && opts->uids[i] != st.st_uid) i++;
+        if (i == opts->nuids) {
+            return 0;
+        }
+    }
+
+    // 2. stat: 부모, 이름, 시작 시각
+    ProcStat st;
+    pid_file_path(path, sizeof(path), pid_name, "stat");
+    if (proc_read_file(proc_fd, path, buf) == -1 || parse_proc_stat(buf->data, buf->len, &st) == -1) {
+        return 0;
+    }
+    if (opts->nppids > 0) {
+        size_t i = 0;
+        while (i < opts->nppids && opts->ppids[i] != st.ppid) i++;
+        if (i == opts->nppids) {
+            return 0;
+        }
+    }
+    if (opts->has_pattern && !opts->full && regexec(&opts->pattern, st.comm, 0, NULL, 0) != 0) {
+        return 0;
+    }
+
+    // 3. cmdline: 앞의 조건을 모두 통과했고 꼭 필요할 때만 읽는다.
+    // (커널 스레드처럼 비어 있으면 pgrep처럼 이름을 대신 쓴다)
+    const char *text = st.comm;
+    if (opts->full || opts->list_full) {
+        pid_file_path(path, sizeof(path), pid_name, "cmdline");
+        if (proc_read_file(proc_fd, path, buf) == 0 && proc_cmdline_text(buf) > 0) {
+            text = buf->data;
+        }
+        if (opts->has_pattern && opts->full && regexec(&opts->pattern, text, 0, NULL, 0) != 0) {
+            return 0;
+        }
+    }
+
+    m->pid = pid;
+    m->starttime = st.starttime;
+    m->text = NULL;
+    if (opts->list_full || opts->list_name || opts->echo) {
+        m->text = strdup(opts->list_full ? text : st.comm);
+        if (!m->text) {
+            perror("strdup");
+            exit(EXIT_FATAL);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 찾은 프로세스에 pidfd로 신호를 보낸다.
+ * @return 보냈으면 1, 그 사이 끝났으면 0, 실패(권한 등)면 -1
+ *
+ * pidfd_open으로 pid를 붙잡은 다음 /proc/<pid>/stat의 starttime을 다시 읽는다.
+ * 찾을 때와 같으면 붙잡은 것이 찾은 그 프로세스이고, 다르면 pid가 재사용된 것이므로 보내지 않는다.
+ * pidfd를 지원하지 않는 커널(5.3 이전)에서는 같은 확인 뒤 kill()로 보낸다.
+ */
+int signal_process(const Match *m, int signo, int proc_fd, ProcBuf *buf) {
+    int pidfd = (int)syscall(SYS_pidfd_open, m->pid, 0);
+    if (pidfd == -1 && errno == ESRCH) {
+        return 0;
+    }
+    if (pidfd == -1 && errno != ENOSYS) {
+        fprintf(stderr, "pkill: pidfd_open %d: %s\n", m->pid, strerror(errno));
+        return -1;
+    }
+
+    char pid_name[16], path[64];
+    ProcStat st;
+    snprintf(pid_name, sizeof(pid_name), "%d", m->pid);
+    pid_file_path(path, sizeof(path), pid_name, "stat");
+    if (proc_read_file(proc_fd, path, buf) == -1 || parse_proc_stat(buf->data, buf->len, &st) == -1 ||
+        st.starttime != m->starttime) {
+        if (pidfd != -1) close(pidfd);
+        return 0;
+    }
+
+    int ret;
+    if (pidfd != -1) {
+        ret = (int)syscall(SYS_pidfd_send_signal, pidfd, signo, NULL, 0);
+        close(pidfd);
+    } else {
+        ret = kill(m->pid, signo);
+    }
+    if (ret == -1) {
+        if (errno == ESRCH) return 0;
+        fprintf(stderr, "pkill: killing pid %d failed: %s\n", m->pid, strerror(errno));
+        return -1;
+    }
+    return 1;
+}
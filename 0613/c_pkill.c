@@ -0,0 +1,5 @@
+// c_pkill: 조건에 맞는 프로세스에 신호를 보낸다. (기본 SIGTERM)
+// 찾는 부분은 c_pgrep과 같으므로 c_pgrep.c를 신호 모드로 빌드한다.
+//   gcc -o c_pkill c_pkill.c
+#define PGREP_DEFAULT_KILL 1
+#include "c_pgrep.c"
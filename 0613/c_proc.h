@@ -0,0 +1,289 @@
+#ifndef C_PROC_H
+#define C_PROC_H
+
+// /proc을 읽는 도구들(c_ps, c_pgrep/c_pkill, c_w)이 함께 쓰는 부품 모음.
+//  - /proc/<pid>/... 파일을 재사용 버퍼에 읽기
+//  - /proc/<pid>/stat 해석 (괄호가 들어간 comm 처리)
+//  - /proc 목록에서 pid 모으기
+//  - cmdline을 한 줄짜리 글자로 바꾸기
+//  - stat의 tty_nr을 터미널 이름으로 바꾸기
+// c_walk.h처럼 모두 static inline 함수로 두어, 일부만 써도 경고가 나지 않는다.
+// memrchr를 쓰므로 포함하는 쪽에서 _GNU_SOURCE를 정의해야 한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/sysmacros.h> // major, minor, makedev
+#include "c_walk.h"     // read_dirents, grow_array
+
+// /proc 파일 시스템의 위치
+// 각 프로세스(PID)의 정보는 /proc/<PID>/ 디렉터리 아래에 파일로 저장된다.
+// 절대 경로를 매번 만드는 대신 /proc을 fd로 열어 두고 "<pid>/stat" 같은 상대 경로를 openat으로 연다.
+#define PROC_DIR "/proc"
+
+// /proc/<pid>/stat 한 줄은 보통 300바이트 안팎이므로 이 크기면 한 번의 read로 끝난다.
+#define PROC_BUF_INITIAL 4096
+
+// /proc 파일 하나를 읽어 둘 버퍼. 스레드마다 하나를 두고 모든 프로세스에 재사용한다.
+typedef struct {
+    char *data;
+    size_t len, cap;
+} ProcBuf;
+
+// /proc/<pid>/stat 에서 꺼낸 값들 (필드 번호는 proc(5) 기준)
+typedef struct {
+    int pid;                        // (1)
+    char comm[64];                  // (2) 괄호 안의 실행 파일 이름 (공백, 괄호 포함 가능)
+    char state;                     // (3) R, S, D, Z, ...
+    int ppid;                       // (4)
+    int pgrp;                       // (5)
+    int session;                    // (6)
+    int tty_nr;                     // (7) 제어 터미널 장치 번호 (없으면 0)
+    int tpgid;                      // (8) 터미널의 포그라운드 프로세스 그룹
+    unsigned long long utime;       // (14) 사용자 모드 CPU 시간 (clock tick)
+    unsigned long long stime;       // (15) 커널 모드 CPU 시간 (clock tick)
+    long nice;                      // (19)
+    long num_threads;               // (20)
+    unsigned long long starttime;   // (22) 부팅 후 시작 시각 (clock tick)
+    unsigned long long vsize;       // (23) 가상 메모리 크기 (바이트)
+    long long rss;                  // (24) 상주 메모리 (페이지 수)
+} ProcStat;
+
+/**
+ * @brief 디렉터리 이름이 숫자로만 이루어진 PID인지 확인
+ * @param name 디렉터리 항목 이름
+ * @return PID 디렉터리면 1, 아니면 0
+ */
+static inline int is_pid_name(const char *name) {
+    if (*name == '\0') {
+        return 0;
+    }
+    for (const char *p = name; *p; p++) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief /proc 아래의 파일 하나를 buf에 통째로 읽는다. (끝에 '\0'을 붙인다)
+ * @param dir_fd 기준 디렉터리 (/proc 또는 /proc/<pid>/task)
+ * @param name dir_fd 기준 경로 ("<pid>/stat", "<tid>/stat" 등)
+ * @param buf 재사용하는 읽기 버퍼 (모자라면 늘어난다)
+ * @return 성공 시 0, 실패 시 -1
+ *
+ * /proc 파일은 read 한 번에 한 덩어리씩 만들어지므로, 대부분 read 한 번으로 끝난다.
+ */
+static inline int proc_read_file(int dir_fd, const char *name, ProcBuf *buf) {
+    int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    buf->len = 0;
+    for (;;) {
+        if (buf->cap - buf->len < 2) {
+            size_t need = buf->cap ? buf->cap * 2 : PROC_BUF_INITIAL;
+            buf->data = grow_array(buf->data, &buf->cap, need, 1);
+        }
+        ssize_t n = read(fd, buf->data + buf->len, buf->cap - buf->len - 1);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1) {
+            close(fd);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        buf->len += (size_t)n;
+    }
+    close(fd);
+    buf->data[buf->len] = '\0';
+    return 0;
+}
+
+// 공백 하나로 구분된 10진수 필드 하나를 읽는다. (음수 가능)
+static inline const char *parse_stat_number(const char *p, const char *end, long long *out) {
+    while (p < end && *p == ' ') p++;
+    int negative = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (unsigned long long)(*p - '0');
+        p++;
+    }
+    *out = negative ? -(long long)v : (long long)v;
+    return p;
+}
+
+/**
+ * @brief /proc/<pid>/stat 내용을 해석한다.
+ * @param data stat 파일 내용
+ * @param len 내용의 길이
+ * @param st 결과를 채울 구조체
+ * @return 성공 시 0, 형식이 맞지 않으면 -1
+ *
+ * comm(2번 필드)은 공백이나 괄호를 포함할 수 있으므로(예: "(sd-pam)", "(a) b)")
+ * scanf의 %s로는 자를 수 없다. 첫 '('와 "마지막" ')' 사이를 comm으로 보고,
+ * 나머지 필드는 그 뒤에서부터 센다. (커널이 괄호를 이스케이프하지 않기 때문)
+ */
+static inline int parse_proc_stat(const char *data, size_t len, ProcStat *st) {
+    const char *end = data + len;
+    const char *lparen = memchr(data, '(', len);
+    const char *rparen = memrchr(data, ')', len);
+    if (!lparen || !rparen || rparen < lparen) {
+        return -1;
+    }
+
+    long long pid;
+    parse_stat_number(data, lparen, &pid);
+    st->pid = (int)pid;
+
+    size_t comm_len = (size_t)(rparen - lparen - 1);
+    if (comm_len >= sizeof(st->comm)) comm_len = sizeof(st->comm) - 1;
+    memcpy(st->comm, lparen + 1, comm_len);
+    st->comm[comm_len] = '\0';
+
+    // ") S 1 1 ..." : 상태 문자 다음부터 숫자 필드가 이어진다.
+    const char *p = rparen + 1;
+    while (p < end && *p == ' ') p++;
+    if (p >= end) {
+        return -1;
+    }
+    st->state = *p++;
+
+    // 4번부터 24번 필드까지 차례로 읽는다.
+    long long f[25] = {0};
+    for (int i = 4; i <= 24 && p < end; i++) {
+        p = parse_stat_number(p, end, &f[i]);
+    }
+    st->ppid = (int)f[4];
+    st->pgrp = (int)f[5];
+    st->session = (int)f[6];
+    st->tty_nr = (int)f[7];
+    st->tpgid = (int)f[8];
+    st->utime = (unsigned long long)f[14];
+    st->stime = (unsigned long long)f[15];
+    st->nice = (long)f[19];
+    st->num_threads = (long)f[20];
+    st->starttime = (unsigned long long)f[22];
+    st->vsize = (unsigned long long)f[23];
+    st->rss = f[24];
+    return 0;
+}
+
+// "<dir>/<file>" 경로를 만든다. (중간 디렉터리를 따로 열지 않고 openat 한 번으로 연다)
+static inline void pid_file_path(char *path, size_t size, const char *pid_name, const char *file) {
+    size_t n = strlen(pid_name), m = strlen(file);
+    if (n + m + 2 > size) {
+        path[0] = '\0';
+        return;
+    }
+    memcpy(path, pid_name, n);
+    path[n] = '/';
+    memcpy(path + n + 1, file, m + 1);
+}
+
+static inline int proc_compare_pid(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief /proc 목록에서 pid를 모아 오름차순으로 돌려준다.
+ * @param proc_fd 열려 있는 /proc (처음부터 읽는다)
+ * @param dirent_buf 목록을 읽을 버퍼 (DIRENT_BUF_SIZE 바이트)
+ * @param count pid 수를 저장
+ * @return malloc한 pid 배열 (호출자가 free). pid가 하나도 없으면 NULL일 수 있다.
+ *
+ * /proc 목록은 보통 pid 순이지만 보장되지는 않으므로 모은 뒤 정렬한다.
+ */
+static inline int *proc_list_pids(int proc_fd, char *dirent_buf, size_t *count) {
+    int *pids = NULL;
+    size_t npids = 0, cap = 0;
+    long nread;
+    lseek(proc_fd, 0, SEEK_SET);
+    while ((nread = read_dirents(proc_fd, dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *)(dirent_buf + off);
+            off += entry->d_reclen;
+            // 숫자로만 이루어진 항목(즉, PID)만 모은다.
+            if (!is_pid_name(entry->d_name)) continue;
+            pids = grow_array(pids, &cap, npids + 1, sizeof(int));
+            pids[npids++] = atoi(entry->d_name);
+        }
+    }
+    if (nread == -1) {
+        perror("getdents64 /proc");
+    }
+    qsort(pids, npids, sizeof(int), proc_compare_pid);
+    *count = npids;
+    return pids;
+}
+
+/**
+ * @brief buf에 읽어 둔 cmdline을 한 줄짜리 글자로 바꾼다.
+ * @return 바꾼 뒤의 길이 (끝의 공백은 뺀다. 커널 스레드처럼 비어 있으면 0)
+ *
+ * 인자 구분자('\0')는 공백으로, 제어 문자는 줄이 깨지지 않도록 '?'로 바꾼다.
+ */
+static inline size_t proc_cmdline_text(ProcBuf *buf) {
+    size_t len = buf->len;
+    for (size_t i = 0; i < len; i++) {
+        if (buf->data[i] == '\0') buf->data[i] = ' ';
+        else if ((unsigned char)buf->data[i] < ' ') buf->data[i] = '?';
+    }
+    while (len > 0 && buf->data[len - 1] == ' ') len--;
+    if (buf->data) buf->data[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief stat의 tty_nr(제어 터미널 장치 번호)을 "pts/3", "tty1" 같은 이름으로 바꾼다.
+ * @param out 결과 버퍼 (제어 터미널이 없으면 "?")
+ *
+ * tty_nr은 커널의 new_encode_dev 형식이라 glibc의 major()/minor()로 그대로 나눌 수 있다.
+ * /dev를 뒤지지 않고 주요 장치 번호로 이름을 정하며, 모르는 장치는 "주번호,부번호"로 적는다.
+ */
+static inline void proc_tty_name(int tty_nr, char *out, size_t size) {
+    if (tty_nr == 0) {
+        snprintf(out, size, "?");
+        return;
+    }
+    unsigned int maj = major((dev_t)(unsigned int)tty_nr);
+    unsigned int min = minor((dev_t)(unsigned int)tty_nr);
+    if (maj >= 136 && maj <= 143) {
+        snprintf(out, size, "pts/%u", (maj - 136) * 256 + min); // UNIX98 가상 터미널
+    } else if (maj == 4 && min < 64) {
+        snprintf(out, size, "tty%u", min);                      // 가상 콘솔
+    } else if (maj == 4) {
+        snprintf(out, size, "ttyS%u", min - 64);                // 직렬 포트
+    } else if (maj == 5 && min == 1) {
+        snprintf(out, size, "console");
+    } else if (maj == 188) {
+        snprintf(out, size, "ttyUSB%u", min);
+    } else {
+        snprintf(out, size, "%u,%u", maj, min);
+    }
+}
+
+/**
+ * @brief 터미널 장치의 st_rdev를 stat의 tty_nr과 같은 형식으로 바꾼다. (proc_tty_name의 반대)
+ *
+ * utmp의 ut_line("pts/3")을 stat하여 얻은 번호를 /proc의 tty_nr과 비교할 때 쓴다.
+ */
+static inline int proc_tty_nr(dev_t rdev) {
+    unsigned int maj = major(rdev), min = minor(rdev);
+    return (int)((min & 0xff) | (maj << 8) | ((min & ~0xffu) << 12));
+}
+
+#endif // C_PROC_H
@@ -1,204 +1,1323 @@
+#define _GNU_SOURCE     // for memrchr
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>     // opendir, readdir, closedir
-#include <ctype.h>      // isdigit
-#include <unistd.h>     // getuid, getopt
-#include <pwd.h>        // getpwuid
-
-// /proc 파일 시스템 내의 파일 경로를 정의하는 매크로
-// 각 프로세스(PID)의 정보는 /proc/<PID>/ 디렉터리 아래에 파일로 저장된다.
-#define PROC_DIR "/proc"
-#define STAT_PATH "/proc/%s/stat"       // 프로세스 상태 정보 (CPU, 메모리 등)
-#define STATUS_PATH "/proc/%s/status"   // 사람이 읽기 쉬운 상태 정보 (UID, GID 등)
-#define CMDLINE_PATH "/proc/%s/cmdline" // 프로세스 실행 시 사용된 전체 명령어
-
-// 프로세스 정보를 담기 위한 구조체
+#include <unistd.h>     // getuid, getopt, read
+#include <fcntl.h>      // openat (pid 디렉터리 기준으로 파일 열기)
+#include <errno.h>      // EINTR
+#include <sys/stat.h>   // fstat (프로세스 소유자 확인)
+#include <time.h>       // clock_gettime, nanosleep (-d 모드)
+#include <getopt.h>     // getopt_long (--sort)
+#include <sys/ioctl.h>  // TIOCGWINSZ (-d 모드 화면 높이)
+#include <sys/resource.h> // getrusage (-d 모드 자체 CPU 사용량)
+#include <stdarg.h>     // va_list (출력 버퍼)
+#include <pthread.h>    // -j 병렬 스캔
+#include <stdatomic.h>  // 작업 스레드가 가져갈 다음 덩어리 번호
+#include "c_walk.h"     // getdents64로 /proc 읽기 (c_ls, c_du와 공유)
+#include "c_idcache.h"  // uid -> 사용자 이름 캐시 (c_ls와 공유)
+#include "c_proc.h"     // /proc 읽기와 stat 해석 (c_pgrep과 공유)
+
+// --- 출력 열(-o)과 정렬(--sort) ---
+//
+// 열마다 값을 얻으려면 무엇을 읽어야 하는지(SRC_*)를 적어 두고, 스냅숏은 고른 열과
+// 필터가 필요로 하는 파일만 연다. 예를 들어 -e -o pid,ppid는 stat만 읽고
+// cmdline이나 status는 열지 않는다.
+
+// 열의 값을 얻기 위해 읽어야 하는 것
+enum {
+    SRC_DIR = 1,        // /proc/<pid> 디렉터리의 stat (소유자 = 유효 UID, 덤프할 수 없는 프로세스는 root)
+                        // 실제 UID(ruser 등)가 필요한 열은 SRC_STATUS의 Uid: 줄을 써야 한다.
+    SRC_STAT = 2,       // /proc/<pid>/stat
+    SRC_CMDLINE = 4,    // /proc/<pid>/cmdline
+    SRC_STATUS = 8,     // /proc/<pid>/status
+};
+
+enum {
+    F_PID, F_TID, F_PPID, F_PGID, F_SID, F_TTY, F_STATE, F_NICE, F_NLWP, F_TIME, F_PCPU,
+    F_VSZ, F_RSS, F_COMM, F_ARGS, F_UID, F_USER, F_EUID, F_EUSER, F_EGID, F_EGROUP
+};
+
+// 저장한 값을 어떻게 보여줄지 (SHOW_TEXT만 문자열 열이고 나머지는 정수 열)
+typedef enum { SHOW_INT, SHOW_CHAR, SHOW_TTY, SHOW_TIME, SHOW_TENTHS, SHOW_TEXT } ShowKind;
+
 typedef struct {
-    char pid[10];
-    char ppid[10];
-    char uid_str[10];
-    char tty_nr[10];  // TTY 정보 (여기서는 간단히 처리)
-    char cmd[512];
-    char user[32];
-} ProcessInfo;
+    const char *name;   // -o, --sort에 쓰는 이름
+    int id;             // F_*
+    const char *header; // 기본 머리글
+    int width;          // 최소 폭. 음수면 왼쪽 정렬
+    int sources;        // 필요한 것 (SRC_*)
+    ShowKind show;
+} FieldDef;
+
+static const FieldDef field_defs[] = {
+    {"pid",     F_PID,    "PID",     5,   0,                      SHOW_INT},
+    {"lwp",     F_TID,    "LWP",     5,   0,                      SHOW_INT},
+    {"spid",    F_TID,    "SPID",    5,   0,                      SHOW_INT},
+    {"tid",     F_TID,    "TID",     5,   0,                      SHOW_INT},
+    {"ppid",    F_PPID,   "PPID",    5,   SRC_STAT,               SHOW_INT},
+    {"pgid",    F_PGID,   "PGID",    5,   SRC_STAT,               SHOW_INT},
+    {"sid",     F_SID,    "SID",     5,   SRC_STAT,               SHOW_INT},
+    {"tty",     F_TTY,    "TTY",     -10, SRC_STAT,               SHOW_TTY},
+    {"s",       F_STATE,  "S",       1,   SRC_STAT,               SHOW_CHAR},
+    {"ni",      F_NICE,   "NI",      3,   SRC_STAT,               SHOW_INT},
+    {"nlwp",    F_NLWP,   "NLWP",    4,   SRC_STAT,               SHOW_INT},
+    {"time",    F_TIME,   "TIME",    8,   SRC_STAT,               SHOW_TIME},
+    {"%cpu",    F_PCPU,   "%CPU",    4,   SRC_STAT,               SHOW_TENTHS},
+    {"pcpu",    F_PCPU,   "%CPU",    4,   SRC_STAT,               SHOW_TENTHS},
+    {"vsz",     F_VSZ,    "VSZ",     7,   SRC_STAT,               SHOW_INT},
+    {"rss",     F_RSS,    "RSS",     6,   SRC_STAT,               SHOW_INT},
+    {"comm",    F_COMM,   "COMMAND", -15, SRC_STAT,               SHOW_TEXT},
+    {"args",    F_ARGS,   "COMMAND", -1,  SRC_STAT | SRC_CMDLINE, SHOW_TEXT},
+    {"cmd",     F_ARGS,   "CMD",     -1,  SRC_STAT | SRC_CMDLINE, SHOW_TEXT},
+    {"command", F_ARGS,   "COMMAND", -1,  SRC_STAT | SRC_CMDLINE, SHOW_TEXT},
+    {"uid",     F_UID,    "UID",     5,   SRC_DIR,                SHOW_INT},
+    {"user",    F_USER,   "USER",    -8,  SRC_DIR,                SHOW_TEXT},
+    {"euid",    F_EUID,   "EUID",    5,   SRC_STATUS,             SHOW_INT},
+    {"euser",   F_EUSER,  "EUSER",   -8,  SRC_STATUS,             SHOW_TEXT},
+    {"egid",    F_EGID,   "EGID",    5,   SRC_STATUS,             SHOW_INT},
+    {"egroup",  F_EGROUP, "EGROUP",  -8,  SRC_STATUS,             SHOW_TEXT},
+};
+
+#define MAX_COLUMNS 32
+
+typedef struct {
+    const FieldDef *def;
+    const char *header;     // -o name=HEADER로 바꿀 수 있다
+    int visible;            // --sort에만 쓰이는 열은 출력하지 않는다
+} Column;
+
+typedef struct {
+    int column;             // Column 번호
+    int descending;         // --sort=-key
+} SortKey;
+
+typedef struct {
+    Column cols[MAX_COLUMNS];
+    int ncols;
+    SortKey keys[MAX_COLUMNS];
+    int nkeys;
+} PsFormat;
+
+// 스냅숏 모드(기본)의 설정
+typedef struct {
+    int show_all_users;     // -e: 모든 사용자의 프로세스 표시
+    int full_format;        // -f: 상세 포맷 (UID, PPID 등) 표시
+    int threads;            // -L/-T: 스레드마다 한 줄 (0이면 프로세스마다, 아니면 옵션 문자)
+    int jobs;               // -j N: /proc을 나눠 읽을 스레드 수
+    uid_t my_uid;
+    PsFormat format;        // -o, --sort
+} PsOptions;
+
+// -d 모드의 정렬 기준
+enum { TOP_SORT_CPU, TOP_SORT_RSS, TOP_SORT_READ, TOP_SORT_WRITE, TOP_SORT_PID };
+
+typedef struct {
+    double delay;           // -d: 갱신 간격 (초)
+    int iterations;         // -n: 출력할 화면 수 (0이면 무한)
+    int sort_key;           // --sort
+    int show_all_users;     // -e
+    uid_t my_uid;
+} TopOptions;
 
 // 함수 선언
-int is_pid_dir(const struct dirent *entry);
-int get_process_info(ProcessInfo *p_info, const char *pid);
-void get_username_from_status(const char *pid, char *username_buf, size_t buf_size);
+void format_add_list(PsFormat *fmt, char *list);
+void format_add_sort(PsFormat *fmt, char *list);
+void run_snapshot(const PsOptions *opts, int proc_fd, char *dirent_buf);
+void run_top(const TopOptions *opts, int proc_fd, char *dirent_buf, ProcBuf *buf);
 
 // 메인 함수
 int main(int argc, char *argv[]) {
-    // 옵션 상태를 저장할 플래그 변수
-    int show_all_users = 0; // -e: 모든 사용자의 프로세스 표시
-    int full_format = 0;    // -f: 상세 포맷 (UID, PPID 등) 표시
-    
-    // 현재 프로그램 실행자의 UID. -u 옵션의 기본값으로 사용된다.
-    uid_t my_uid = getuid();
-    
+    PsOptions opts = {0}; // 스냅숏 모드 설정
+    opts.jobs = 1;
+    // 현재 프로그램 실행자의 UID. -e가 없을 때 이 사용자의 프로세스만 보여준다.
+    opts.my_uid = getuid();
+
+    TopOptions top = {0}; // -d 모니터링 모드 설정
+    top.sort_key = TOP_SORT_CPU;
+    char *sort_arg = NULL; // --sort: -d 모드인지 알아야 해석할 수 있으므로 나중에 본다.
+
+    static const struct option long_opts[] = {
+        {"sort", required_argument, NULL, 's'},
+        {NULL, 0, NULL, 0}
+    };
+
     int opt;
-    // getopt를 사용하여 명령줄 옵션을 파싱
-    while ((opt = getopt(argc, argv, "ef")) != -1) {
+    // getopt_long을 사용하여 명령줄 옵션을 파싱
+    while ((opt = getopt_long(argc, argv, "efLTo:j:d:n:", long_opts, NULL)) != -1) {
         switch (opt) {
             case 'e':
-                show_all_users = 1;
+                opts.show_all_users = 1;
                 break;
             case 'f':
-                full_format = 1;
+                opts.full_format = 1;
+                break;
+            case 'L':
+            case 'T':
+                opts.threads = opt;
+                break;
+            case 'o':
+                format_add_list(&opts.format, optarg);
+                break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                if (opts.jobs < 1) {
+                    fprintf(stderr, "ps: invalid number of jobs: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'd':
+                top.delay = atof(optarg);
+                if (top.delay <= 0) {
+                    fprintf(stderr, "ps: invalid delay: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'n':
+                top.iterations = atoi(optarg);
+                break;
+            case 's':
+                sort_arg = optarg;
                 break;
             default:
-                fprintf(stderr, "사용법: %s [-e] [-f]\n", argv[0]);
+                fprintf(stderr, "사용법: %s [-e] [-f] [-L|-T] [-o FIELD,...] [--sort=[-]FIELD,...] [-j N]\n"
+                                "       %s [-e] -d SECONDS [-n COUNT] [--sort=cpu|rss|read|write|pid]\n",
+                        argv[0], argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
-    
-    DIR *proc_dir = opendir(PROC_DIR);
-    if (!proc_dir) {
-        perror("opendir /proc");
+
+    if (top.delay > 0 && sort_arg) {
+        if (strcmp(sort_arg, "cpu") == 0) top.sort_key = TOP_SORT_CPU;
+        else if (strcmp(sort_arg, "rss") == 0) top.sort_key = TOP_SORT_RSS;
+        else if (strcmp(sort_arg, "read") == 0) top.sort_key = TOP_SORT_READ;
+        else if (strcmp(sort_arg, "write") == 0) top.sort_key = TOP_SORT_WRITE;
+        else if (strcmp(sort_arg, "pid") == 0) top.sort_key = TOP_SORT_PID;
+        else {
+            fprintf(stderr, "ps: unknown sort key: %s (cpu, rss, read, write, pid)\n", sort_arg);
+            exit(EXIT_FAILURE);
+        }
+    } else if (top.delay <= 0) {
+        // -o가 없으면 옵션에 맞는 기본 열을 쓴다.
+        if (opts.format.ncols == 0) {
+            char defaults[64];
+            const char *tid = opts.threads == 'T' ? "spid" : "lwp";
+            if (opts.full_format && opts.threads) {
+                snprintf(defaults, sizeof(defaults), "user,pid,ppid,%s,nlwp,cmd", tid);
+            } else if (opts.full_format) {
+                snprintf(defaults, sizeof(defaults), "user,pid,ppid,cmd");
+            } else if (opts.threads) {
+                snprintf(defaults, sizeof(defaults), "pid,%s,tty,cmd", tid);
+            } else {
+                snprintf(defaults, sizeof(defaults), "pid,tty,cmd");
+            }
+            format_add_list(&opts.format, defaults);
+            if (opts.full_format) {
+                opts.format.cols[0].header = "UID"; // ps -f처럼 이름을 UID 머리글 아래에 보여준다.
+            }
+        }
+        if (sort_arg) {
+            format_add_sort(&opts.format, sort_arg);
+        }
+    }
+
+    // 여러 사용자의 프로세스를 훑을 때는 /etc/passwd를 미리 한 번에 읽어 둔다.
+    // (스냅숏 모드는 사용자 이름 열이 있을 때만 run_snapshot에서 읽는다)
+    if (top.delay > 0) {
+        idcache_warm();
+    }
+
+    int proc_fd = open(PROC_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    char *dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (proc_fd == -1) {
+        perror("open /proc");
+        exit(EXIT_FAILURE);
+    }
+    if (!dirent_buf) {
+        perror("malloc");
         exit(EXIT_FAILURE);
     }
-    
-    struct dirent *entry;
 
-    // 헤더 출력: -f 옵션 여부에 따라 다르게 출력
-    if (full_format) {
-        printf("%-8s %5s %5s %-20s\n", "UID", "PID", "PPID", "CMD");
+    if (top.delay > 0) {
+        // -d: top처럼 주기적으로 갱신하며 보여준다.
+        ProcBuf buf = {0}; // 모든 프로세스가 함께 쓰는 읽기 버퍼
+        top.show_all_users = opts.show_all_users;
+        top.my_uid = opts.my_uid;
+        run_top(&top, proc_fd, dirent_buf, &buf);
+        free(buf.data);
     } else {
-        printf("%5s %-10s %s\n", "PID", "TTY", "CMD");
+        run_snapshot(&opts, proc_fd, dirent_buf);
     }
-    
-    // /proc 디렉터리를 순회하며 각 항목을 읽음
-    while ((entry = readdir(proc_dir)) != NULL) {
-        // 현재 항목이 숫자로만 이루어진 디렉터리(즉, PID)인지 확인
-        if (!is_pid_dir(entry)) {
-            continue;
+
+    free(dirent_buf);
+    close(proc_fd);
+    return 0;
+}
+
+// --- -o, --sort 해석 ---
+
+static const FieldDef *find_field(const char *name) {
+    for (size_t i = 0; i < sizeof(field_defs) / sizeof(field_defs[0]); i++) {
+        if (strcmp(field_defs[i].name, name) == 0) return &field_defs[i];
+    }
+    fprintf(stderr, "ps: unknown field: %s\n사용할 수 있는 필드:", name);
+    for (size_t i = 0; i < sizeof(field_defs) / sizeof(field_defs[0]); i++) {
+        fprintf(stderr, " %s", field_defs[i].name);
+    }
+    fputc('\n', stderr);
+    exit(EXIT_FAILURE);
+}
+
+// 열을 하나 추가하고 그 번호를 돌려준다.
+static int format_add_column(PsFormat *fmt, const FieldDef *def, const char *header, int visible) {
+    if (fmt->ncols >= MAX_COLUMNS) {
+        fprintf(stderr, "ps: too many fields (max %d)\n", MAX_COLUMNS);
+        exit(EXIT_FAILURE);
+    }
+    Column *col = &fmt->cols[fmt->ncols];
+    col->def = def;
+    col->header = header ? header : def->header;
+    col->visible = visible;
+    return fmt->ncols++;
+}
+
+/**
+ * @brief -o 인자("pid,ppid,user=OWNER")의 열들을 추가한다.
+ * @param list 쉼표로 구분한 필드 목록 (내용이 잘린다)
+ *
+ * ps처럼 '=' 뒤는 인자 끝까지 머리글로 본다. 모든 머리글이 비어 있으면 머리글 줄을 찍지 않는다.
+ */
+void format_add_list(PsFormat *fmt, char *list) {
+    while (*list) {
+        char *comma = strchr(list, ',');
+        char *eq = strchr(list, '=');
+        const char *header = NULL;
+        if (eq && (!comma || eq < comma)) {
+            *eq = '\0';
+            header = eq + 1;
+            comma = NULL;
+        } else if (comma) {
+            *comma = '\0';
         }
+        if (*list) {
+            format_add_column(fmt, find_field(list), header, 1);
+        }
+        if (!comma) break;
+        list = comma + 1;
+    }
+}
 
-        ProcessInfo p_info = {0}; // 구조체 초기화
-        // 프로세스 정보를 가져온다. 실패 시 건너뜀.
-        if (!get_process_info(&p_info, entry->d_name)) {
-            continue;
+/**
+ * @brief --sort 인자("-rss,pid")의 정렬 키를 추가한다. '-'는 내림차순, '+'나 없으면 오름차순.
+ *
+ * 출력하지 않는 필드로 정렬하면 보이지 않는 열로 추가해 값을 모은다.
+ */
+void format_add_sort(PsFormat *fmt, char *list) {
+    for (char *key = strtok(list, ","); key; key = strtok(NULL, ",")) {
+        int descending = 0;
+        if (*key == '-' || *key == '+') {
+            descending = (*key == '-');
+            key++;
         }
-        
-        // --- 옵션에 따른 필터링 ---
-        // -e 옵션이 없으면, 현재 사용자의 프로세스만 보여준다.
-        if (!show_all_users) {
-            uid_t process_uid = (uid_t)atoi(p_info.uid_str);
-            if (process_uid != my_uid) {
-                continue;
+        const FieldDef *def = find_field(key);
+        int column = -1;
+        for (int i = 0; i < fmt->ncols; i++) {
+            if (fmt->cols[i].def->id == def->id) {
+                column = i;
+                break;
             }
         }
-        
-        // --- 최종 출력 ---
-        if (full_format) { // -f 옵션: UID, PID, PPID, CMD
-            printf("%-8s %5s %5s %-20s\n", p_info.user, p_info.pid, p_info.ppid, p_info.cmd);
-        } else { // 기본: PID, TTY, CMD
-            printf("%5s %-10s %s\n", p_info.pid, p_info.tty_nr, p_info.cmd);
+        if (column < 0) {
+            column = format_add_column(fmt, def, NULL, 0);
         }
+        if (fmt->nkeys >= MAX_COLUMNS) {
+            fprintf(stderr, "ps: too many sort keys (max %d)\n", MAX_COLUMNS);
+            exit(EXIT_FAILURE);
+        }
+        fmt->keys[fmt->nkeys].column = column;
+        fmt->keys[fmt->nkeys].descending = descending;
+        fmt->nkeys++;
     }
-    
-    closedir(proc_dir);
-    return 0;
+}
+
+// --- 스냅숏 모드: /proc을 한 번 훑어 출력한다 ---
+//
+// pid 목록을 먼저 모아 정렬한 뒤 SCAN_CHUNK개씩 덩어리로 나누고, 작업 스레드가
+// 덩어리를 하나씩 가져가 각자의 읽기 버퍼로 처리한다. 덩어리마다 값을 따로 모아
+// 두었다가 덩어리 순서대로 이어 붙이므로, 스레드 수와 관계없이 pid 순서가 유지된다.
+// 덩어리를 작게 두어 스레드가 많은 프로세스(-L)가 한 스레드에 몰려도 나머지가 일을 나눠 갖는다.
+//
+// 값은 열별로 저장한다. (열마다 배열 하나) 정렬은 키 열만 훑고, 폭 계산도 한 열씩 하며,
+// 출력에 필요한 글자 변환(TTY 이름, 시간 형식 등)은 찍을 때 한 번만 한다.
+#define SCAN_CHUNK 64
+
+// 글자 열의 문자열을 모아 두는 블록. 블록은 옮겨지지 않으므로 포인터를 그대로 저장한다.
+#define STR_BLOCK_SIZE (64 * 1024)
+
+typedef struct StrBlock {
+    struct StrBlock *next;
+    size_t used, cap;
+    char data[];
+} StrBlock;
+
+typedef struct {
+    size_t rows, cap;
+    long long *num[MAX_COLUMNS];        // 정수 열 (SHOW_TEXT가 아닌 열)
+    const char **text[MAX_COLUMNS];     // 글자 열 (SHOW_TEXT)
+    StrBlock *strings;
+} Snapshot;
+
+typedef struct {
+    const PsOptions *opts;
+    int proc_fd;
+    int sources;            // 읽어야 하는 것 (SRC_*)
+    long clk_tck, page_kb;
+    double uptime;          // %cpu 계산용 (부팅 후 초)
+    const int *pids;        // 정렬된 pid 목록
+    size_t npids;
+    Snapshot *chunks;       // 덩어리마다 모은 값
+    size_t nchunks;
+    atomic_size_t next;     // 다음에 가져갈 덩어리 번호
+} ScanJob;
+
+// 행 하나를 채우는 데 쓰는 원본 값 (sources에 없는 것은 채워지지 않는다)
+typedef struct {
+    int pid, tid;
+    uid_t uid;                  // SRC_DIR (/proc/<pid>의 소유자)
+    const ProcStat *stat;       // SRC_STAT (-L/-T면 스레드의 stat)
+    const char *cmdline;        // SRC_CMDLINE (비어 있을 수 있다)
+    uid_t euid;                 // SRC_STATUS
+    gid_t egid;
+} RowData;
+
+static int is_text_column(const Column *col) {
+    return col->def->show == SHOW_TEXT;
+}
+
+static const char *snapshot_strdup(Snapshot *snap, const char *s, size_t len) {
+    StrBlock *b = snap->strings;
+    if (!b || b->cap - b->used < len + 1) {
+        size_t cap = len + 1 > STR_BLOCK_SIZE ? len + 1 : STR_BLOCK_SIZE;
+        b = malloc(sizeof(StrBlock) + cap);
+        if (!b) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        b->next = snap->strings;
+        b->used = 0;
+        b->cap = cap;
+        snap->strings = b;
+    }
+    char *copy = b->data + b->used;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    b->used += len + 1;
+    return copy;
+}
+
+// 모든 열이 need개의 행을 담을 수 있게 한다.
+static void snapshot_reserve(Snapshot *snap, const PsFormat *fmt, size_t need) {
+    if (need <= snap->cap) return;
+    size_t cap = snap->cap;
+    for (int c = 0; c < fmt->ncols; c++) {
+        cap = snap->cap; // 열마다 같은 크기로 늘린다.
+        if (is_text_column(&fmt->cols[c])) {
+            snap->text[c] = grow_array(snap->text[c], &cap, need, sizeof(const char *));
+        } else {
+            snap->num[c] = grow_array(snap->num[c], &cap, need, sizeof(long long));
+        }
+    }
+    snap->cap = cap;
+}
+
+static void snapshot_free(Snapshot *snap, int ncols) {
+    for (int c = 0; c < ncols; c++) {
+        free(snap->num[c]);
+        free(snap->text[c]);
+    }
+    while (snap->strings) {
+        StrBlock *next = snap->strings->next;
+        free(snap->strings);
+        snap->strings = next;
+    }
+}
+
+static void snapshot_add_row(Snapshot *snap, const ScanJob *job, const RowData *row) {
+    const PsFormat *fmt = &job->opts->format;
+    const ProcStat *st = row->stat; // SRC_STAT 열에서만 쓴다.
+    snapshot_reserve(snap, fmt, snap->rows + 1);
+    size_t r = snap->rows++;
+
+    for (int c = 0; c < fmt->ncols; c++) {
+        long long v = 0;
+        const char *text = NULL;
+        switch (fmt->cols[c].def->id) {
+            case F_PID: v = row->pid; break;
+            case F_TID: v = row->tid; break;
+            case F_PPID: v = st->ppid; break;
+            case F_PGID: v = st->pgrp; break;
+            case F_SID: v = st->session; break;
+            case F_TTY: v = st->tty_nr; break;
+            case F_STATE: v = st->state; break;
+            case F_NICE: v = st->nice; break;
+            case F_NLWP: v = st->num_threads; break;
+            case F_TIME: v = (long long)((st->utime + st->stime) / (unsigned long long)job->clk_tck); break;
+            case F_PCPU: {
+                // 시작 이후 평균 CPU 사용률 (ps와 같은 정의), 0.1% 단위
+                double elapsed = job->uptime - (double)st->starttime / job->clk_tck;
+                double cpu = (double)(st->utime + st->stime) / job->clk_tck;
+                v = elapsed > 0 ? (long long)(cpu / elapsed * 1000.0) : 0;
+                break;
+            }
+            case F_VSZ: v = (long long)(st->vsize / 1024); break;
+            case F_RSS: v = st->rss * job->page_kb; break;
+            case F_COMM: text = snapshot_strdup(snap, st->comm, strlen(st->comm)); break;
+            case F_ARGS:
+                if (row->cmdline && row->cmdline[0]) {
+                    text = row->cmdline;
+                } else {
+                    // cmdline이 비어 있으면 (커널 스레드, 좀비 등) ps처럼 [comm]으로 보여준다.
+                    char tmp[sizeof(st->comm) + 2];
+                    int n = snprintf(tmp, sizeof(tmp), "[%s]", st->comm);
+                    text = snapshot_strdup(snap, tmp, (size_t)n);
+                }
+                break;
+            case F_UID: v = row->uid; break;
+            case F_USER: text = idcache_user(row->uid, NULL); break; // 캐시의 문자열은 계속 유효하다.
+            case F_EUID: v = row->euid; break;
+            case F_EUSER: text = idcache_user(row->euid, NULL); break;
+            case F_EGID: v = row->egid; break;
+            case F_EGROUP: text = idcache_group(row->egid, NULL); break;
+        }
+        if (is_text_column(&fmt->cols[c])) {
+            snap->text[c][r] = text;
+        } else {
+            snap->num[c][r] = v;
+        }
+    }
+}
+
+// status의 "Uid:\t실제\t유효\t..." 같은 줄에서 두 번째 값(유효 id)을 꺼낸다.
+static unsigned long status_effective_id(const char *data, const char *key) {
+    const char *p = strstr(data, key);
+    if (!p) {
+        return 0;
+    }
+    char *end;
+    strtoul(p + strlen(key), &end, 10); // 실제 id는 건너뛴다.
+    return strtoul(end, NULL, 10);
 }
 
 /**
- * @brief direntry가 숫자로만 이루어진 디렉토리 이름(PID)인지 확인
- * @param entry readdir()로 읽은 dirent 구조체 포인터
- * @return PID 디렉터리면 1, 아니면 0
+ * @brief pid 하나를 읽어 snap에 행을 덧붙인다. (-L/-T면 스레드마다 한 행)
+ * @param buf 이 스레드의 읽기 버퍼
+ * @param task_buf -L/-T일 때 /proc/<pid>/task 목록을 읽을 버퍼
+ *
+ * job->sources에 있는 것만 읽는다. 경로는 /proc 기준("<pid>/stat")으로 열어
+ * pid 디렉터리를 따로 열고 닫는 시스템 호출을 아낀다.
  */
-int is_pid_dir(const struct dirent *entry) {
-    for (const char *p = entry->d_name; *p; p++) {
-        if (!isdigit(*p)) {
+static void scan_process(const ScanJob *job, int pid, ProcBuf *buf, char *task_buf, Snapshot *snap) {
+    const PsOptions *opts = job->opts;
+    char pid_name[16], path[64];
+    snprintf(pid_name, sizeof(pid_name), "%d", pid);
+
+    RowData row = {0};
+    row.pid = row.tid = pid;
+
+    // --- 옵션에 따른 필터링 ---
+    // 소유자는 디렉터리의 stat 한 번으로 알 수 있으므로, 파일을 읽기 전에 거른다.
+    // 그 사이 프로세스가 끝났으면 건너뛴다.
+    if (job->sources & SRC_DIR) {
+        struct stat st;
+        if (fstatat(job->proc_fd, pid_name, &st, 0) == -1 ||
+            (!opts->show_all_users && st.st_uid != opts->my_uid)) {
+            return;
+        }
+        row.uid = st.st_uid;
+    }
+
+    ProcStat st;
+    if ((job->sources & SRC_STAT) && !opts->threads) {
+        pid_file_path(path, sizeof(path), pid_name, "stat");
+        if (proc_read_file(job->proc_fd, path, buf) == -1 ||
+            parse_proc_stat(buf->data, buf->len, &st) == -1) {
+            return;
+        }
+        row.stat = &st;
+    }
+
+    if (job->sources & SRC_STATUS) {
+        pid_file_path(path, sizeof(path), pid_name, "status");
+        if (proc_read_file(job->proc_fd, path, buf) == -1) {
+            return;
+        }
+        row.euid = (uid_t)status_effective_id(buf->data, "\nUid:");
+        row.egid = (gid_t)status_effective_id(buf->data, "\nGid:");
+    }
+
+    if (job->sources & SRC_CMDLINE) {
+        size_t len = 0;
+        pid_file_path(path, sizeof(path), pid_name, "cmdline");
+        if (proc_read_file(job->proc_fd, path, buf) == 0) {
+            len = proc_cmdline_text(buf);
+        }
+        row.cmdline = snapshot_strdup(snap, buf->data ? buf->data : "", len);
+    }
+
+    if (!opts->threads) {
+        snapshot_add_row(snap, job, &row);
+        return;
+    }
+
+    // -L/-T: /proc/<pid>/task/<tid>를 훑어 스레드마다 한 행씩 만든다.
+    // 명령줄과 사용자는 스레드가 모두 같으므로 프로세스의 것을 쓴다. (ps와 같음)
+    pid_file_path(path, sizeof(path), pid_name, "task");
+    int task_fd = openat(job->proc_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (task_fd == -1) {
+        return;
+    }
+    long nread;
+    while ((nread = read_dirents(task_fd, task_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(task_buf + off);
+            off += d->d_reclen;
+            if (!is_pid_name(d->d_name)) continue;
+
+            row.tid = atoi(d->d_name);
+            if (job->sources & SRC_STAT) {
+                pid_file_path(path, sizeof(path), d->d_name, "stat");
+                if (proc_read_file(task_fd, path, buf) == -1 ||
+                    parse_proc_stat(buf->data, buf->len, &st) == -1) {
+                    continue; // 그 사이 끝난 스레드
+                }
+                row.stat = &st;
+            }
+            snapshot_add_row(snap, job, &row);
+        }
+    }
+    close(task_fd);
+}
+
+// 작업 스레드: 남은 덩어리가 없을 때까지 하나씩 가져가 처리한다.
+static void *scan_worker(void *arg) {
+    ScanJob *job = arg;
+    ProcBuf buf = {0};
+    char *task_buf = NULL;
+    if (job->opts->threads) {
+        task_buf = malloc(DIRENT_BUF_SIZE);
+        if (!task_buf) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t chunk;
+    while ((chunk = atomic_fetch_add(&job->next, 1)) < job->nchunks) {
+        size_t begin = chunk * SCAN_CHUNK;
+        size_t end = begin + SCAN_CHUNK < job->npids ? begin + SCAN_CHUNK : job->npids;
+        for (size_t i = begin; i < end; i++) {
+            scan_process(job, job->pids[i], &buf, task_buf, &job->chunks[chunk]);
+        }
+    }
+
+    free(task_buf);
+    free(buf.data);
+    return NULL;
+}
+
+// 덩어리들을 순서대로 이어 붙여 하나의 스냅숏으로 만든다. (덩어리 순서 = pid 순서)
+static void snapshot_merge(Snapshot *all, Snapshot *chunks, size_t nchunks, const PsFormat *fmt) {
+    size_t total = 0;
+    for (size_t i = 0; i < nchunks; i++) total += chunks[i].rows;
+    memset(all, 0, sizeof(*all));
+    snapshot_reserve(all, fmt, total);
+
+    for (size_t i = 0; i < nchunks; i++) {
+        Snapshot *part = &chunks[i];
+        for (int c = 0; c < fmt->ncols; c++) {
+            if (part->rows == 0) break;
+            if (is_text_column(&fmt->cols[c])) {
+                memcpy(all->text[c] + all->rows, part->text[c], part->rows * sizeof(const char *));
+            } else {
+                memcpy(all->num[c] + all->rows, part->num[c], part->rows * sizeof(long long));
+            }
+        }
+        all->rows += part->rows;
+        // 문자열 블록은 옮기지 않고 목록만 넘겨받는다.
+        while (part->strings) {
+            StrBlock *b = part->strings;
+            part->strings = b->next;
+            b->next = all->strings;
+            all->strings = b;
+        }
+        snapshot_free(part, fmt->ncols);
+    }
+}
+
+typedef struct {
+    const Snapshot *snap;
+    const PsFormat *fmt;
+} SortContext;
+
+// --sort 키 순서대로 비교하고, 모두 같으면 원래 순서(pid 순)를 유지한다.
+static int compare_rows(const void *a, const void *b, void *arg) {
+    const SortContext *ctx = arg;
+    const PsFormat *fmt = ctx->fmt;
+    const Snapshot *snap = ctx->snap;
+    size_t x = *(const size_t *)a, y = *(const size_t *)b;
+    for (int k = 0; k < fmt->nkeys; k++) {
+        int c = fmt->keys[k].column;
+        int r;
+        if (is_text_column(&fmt->cols[c])) {
+            const char *tx = snap->text[c][x], *ty = snap->text[c][y];
+            r = strcmp(tx ? tx : "", ty ? ty : "");
+        } else {
+            long long vx = snap->num[c][x], vy = snap->num[c][y];
+            r = (vx > vy) - (vx < vy);
+        }
+        if (r != 0) {
+            return fmt->keys[k].descending ? -r : r;
+        }
+    }
+    return (x > y) - (x < y);
+}
+
+// 터미널 장치 번호를 이름으로 바꾼다.
+static void format_tty(int tty_nr, char *out, size_t size) {
+    proc_tty_name(tty_nr, out, size); // c_proc.h: 주/부 장치 번호로 "pts/3", "tty1" 등
+}
+
+// 칸 하나를 글자로 만든다. 글자 열이면 저장한 문자열을 그대로 돌려준다.
+static const char *format_cell(const Snapshot *snap, const Column *col, int c, size_t r,
+                               char *tmp, size_t size) {
+    if (is_text_column(col)) {
+        return snap->text[c][r] ? snap->text[c][r] : "?";
+    }
+    long long v = snap->num[c][r];
+    switch (col->def->show) {
+        case SHOW_CHAR:
+            snprintf(tmp, size, "%c", (char)v);
+            break;
+        case SHOW_TTY:
+            format_tty((int)v, tmp, size);
+            break;
+        case SHOW_TIME: // [일-]시:분:초
+            if (v >= 86400) {
+                snprintf(tmp, size, "%lld-%02lld:%02lld:%02lld", v / 86400, v / 3600 % 24, v / 60 % 60, v % 60);
+            } else {
+                snprintf(tmp, size, "%02lld:%02lld:%02lld", v / 3600, v / 60 % 60, v % 60);
+            }
+            break;
+        case SHOW_TENTHS:
+            snprintf(tmp, size, "%lld.%lld", v / 10, v % 10);
+            break;
+        default:
+            snprintf(tmp, size, "%lld", v);
+            break;
+    }
+    return tmp;
+}
+
+// 폭에 맞춰 칸 하나를 찍는다. 마지막 열이 왼쪽 정렬이면 뒤에 공백을 붙이지 않는다.
+static void print_cell(const char *text, int width, int is_first, int is_last) {
+    int len = (int)strlen(text);
+    if (!is_first) putchar(' ');
+    if (width < 0) {
+        fputs(text, stdout);
+        if (!is_last) printf("%*s", -width > len ? -width - len : 0, "");
+    } else {
+        printf("%*s", width > len ? width - len : 0, "");
+        fputs(text, stdout);
+    }
+}
+
+static void print_snapshot(const Snapshot *snap, const PsFormat *fmt, const size_t *order) {
+    int widths[MAX_COLUMNS];
+    int first = -1, last = -1, any_header = 0;
+    char tmp[64];
+
+    // 폭 = 기본 폭, 머리글, 실제 값 중 가장 긴 것 (마지막 열은 맞출 필요가 없다)
+    for (int c = 0; c < fmt->ncols; c++) {
+        if (!fmt->cols[c].visible) continue;
+        if (first < 0) first = c;
+        last = c;
+    }
+    for (int c = 0; c < fmt->ncols; c++) {
+        const Column *col = &fmt->cols[c];
+        if (!col->visible) continue;
+        int w = abs(col->def->width);
+        int header_len = (int)strlen(col->header);
+        if (header_len > 0) any_header = 1;
+        if (header_len > w) w = header_len;
+        if (c != last) {
+            for (size_t r = 0; r < snap->rows; r++) {
+                int len = (int)strlen(format_cell(snap, col, c, r, tmp, sizeof(tmp)));
+                if (len > w) w = len;
+            }
+        }
+        widths[c] = col->def->width < 0 ? -w : w;
+    }
+
+    if (any_header) {
+        for (int c = 0; c < fmt->ncols; c++) {
+            if (fmt->cols[c].visible) print_cell(fmt->cols[c].header, widths[c], c == first, c == last);
+        }
+        putchar('\n');
+    }
+    for (size_t i = 0; i < snap->rows; i++) {
+        size_t r = order[i];
+        for (int c = 0; c < fmt->ncols; c++) {
+            if (!fmt->cols[c].visible) continue;
+            print_cell(format_cell(snap, &fmt->cols[c], c, r, tmp, sizeof(tmp)), widths[c], c == first, c == last);
+        }
+        putchar('\n');
+    }
+}
+
+/**
+ * @brief /proc을 한 번 훑어 프로세스(-L/-T면 스레드) 목록을 출력한다.
+ * @param dirent_buf /proc 목록을 읽을 버퍼 (DIRENT_BUF_SIZE 바이트)
+ *
+ * --sort가 없으면 pid 순으로 출력한다.
+ */
+void run_snapshot(const PsOptions *opts, int proc_fd, char *dirent_buf) {
+    const PsFormat *fmt = &opts->format;
+    ScanJob job;
+    memset(&job, 0, sizeof(job));
+    job.opts = opts;
+    job.proc_fd = proc_fd;
+
+    // 고른 열과 필터가 필요로 하는 것만 읽는다.
+    int uses_names = 0;
+    job.sources = opts->show_all_users ? 0 : SRC_DIR;
+    for (int c = 0; c < fmt->ncols; c++) {
+        int id = fmt->cols[c].def->id;
+        job.sources |= fmt->cols[c].def->sources;
+        if (id == F_USER || id == F_EUSER || id == F_EGROUP) uses_names = 1;
+    }
+    // 여러 사용자의 프로세스를 훑을 때는 /etc/passwd를 미리 한 번에 읽어 둔다.
+    if (uses_names && opts->show_all_users) {
+        idcache_warm();
+    }
+    job.clk_tck = sysconf(_SC_CLK_TCK);
+    job.page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    struct timespec boot;
+    clock_gettime(CLOCK_BOOTTIME, &boot); // starttime과 같은 기준 (부팅 후 경과 시간)
+    job.uptime = (double)boot.tv_sec + (double)boot.tv_nsec / 1e9;
+
+    size_t npids;
+    int *pids = proc_list_pids(proc_fd, dirent_buf, &npids);
+
+    job.pids = pids;
+    job.npids = npids;
+    job.nchunks = (npids + SCAN_CHUNK - 1) / SCAN_CHUNK;
+    job.chunks = calloc(job.nchunks + 1, sizeof(Snapshot));
+    if (!job.chunks) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&job.next, 0);
+
+    // 메인 스레드도 작업 스레드 하나로 일한다. (-j 1이면 스레드를 만들지 않는다)
+    int extra = opts->jobs - 1;
+    pthread_t *threads = extra > 0 ? calloc((size_t)extra, sizeof(pthread_t)) : NULL;
+    int started = 0;
+    for (; started < extra; started++) {
+        if (pthread_create(&threads[started], NULL, scan_worker, &job) != 0) {
+            perror("pthread_create");
+            break; // 만든 스레드만으로 계속한다.
+        }
+    }
+    scan_worker(&job);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    Snapshot all;
+    snapshot_merge(&all, job.chunks, job.nchunks, fmt);
+
+    size_t *order = malloc((all.rows + 1) * sizeof(size_t));
+    if (!order) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < all.rows; i++) order[i] = i;
+    if (fmt->nkeys > 0) {
+        SortContext ctx = { &all, fmt };
+        qsort_r(order, all.rows, sizeof(size_t), compare_rows, &ctx);
+    }
+    print_snapshot(&all, fmt, order);
+
+    snapshot_free(&all, fmt->ncols);
+    free(order);
+    free(threads);
+    free(job.chunks);
+    free(pids);
+}
+
+// --- -d SECONDS: top처럼 주기적으로 갱신하는 모니터링 모드 ---
+//
+// 프로세스마다 이전 틱의 누적값(CPU 시간, 입출력 바이트)을 해시 테이블에 기억해 두고,
+// 다음 틱에서 차이를 구해 CPU%와 초당 입출력량을 계산한다.
+// 프로세스는 (pid, starttime)으로 구분하므로 pid가 재사용되면 새 프로세스로 다룬다.
+//
+// 틱마다 드는 비용을 줄이기 위해:
+//  - stat/io 파일은 처음 볼 때 한 번 열어 두고, 이후에는 pread(fd, 0) 한 번으로 다시 읽는다.
+//    (/proc 파일은 읽을 때마다 내용을 새로 만든다) 프로세스가 끝나면 이 fd의 읽기가
+//    실패하므로, 같은 pid가 재사용되어도 끝난 프로세스의 값을 잘못 읽지 않는다.
+//  - 명령줄(cmdline)과 사용자 이름은 처음 봤을 때 한 번만 읽는다.
+//  - /proc 목록은 새 프로세스를 찾기 위해 틱마다 한 번만 훑는다.
+//  - io를 읽을 권한이 없는 프로세스는 다시 시도하지 않는다.
+//  - 지난 틱 이후 CPU 시간이 늘지 않았고 실행 중(R)이나 입출력 대기(D)가 아닌 프로세스는
+//    입출력 시스템 호출도 하지 않았다고 보고 io를 다시 읽지 않는다. 나중에 다시 읽을 때는
+//    마지막으로 읽은 시각부터의 평균으로 계산하므로 누적량은 빠지지 않는다.
+// fd를 더 열 수 없으면(RLIMIT_NOFILE) 그 프로세스는 틱마다 경로로 열어 읽는다.
+
+// 프로세스 하나의 상태 (pid가 0이면 빈 슬롯)
+typedef struct {
+    int pid;
+    unsigned long long starttime;
+    int stat_fd, io_fd;                 // 열어 둔 /proc/<pid>/stat, io (-1이면 없음)
+    unsigned long long cpu_ticks;       // 지난 틱의 utime + stime
+    unsigned long long read_bytes, write_bytes;
+    double io_time;                     // io를 마지막으로 읽은 시각 (부팅 후 초)
+    unsigned long seen_tick;            // 마지막으로 본 틱 번호
+    int hidden;                         // 다른 사용자의 프로세스 (-e가 없을 때). stat을 열지 않는다
+    ino_t dir_ino;                      // 숨긴 항목: /proc/<pid>의 inode (pid 재사용 확인용)
+    int io_state;                       // 0: 아직 없음, 1: 읽음, -1: 읽을 수 없음
+    const char *user;
+    char *cmd;                          // 처음 한 번만 읽는다
+    // 이번 틱에서 계산한 값
+    double cpu_pct;
+    long long rss_kb;
+    double read_rate, write_rate;       // 바이트/초
+} TopEntry;
+
+// 숨긴(다른 사용자의) 항목의 소유자를 다시 확인하는 주기 (틱). pid에 따라 틱마다 나누어 확인한다.
+#define TOP_OWNER_RECHECK_TICKS 10
+
+// 개방 주소법 해시 테이블. /proc 목록에서 얻는 것은 pid뿐이므로 pid로 찾고,
+// stat을 읽은 뒤 starttime이 다르면 재사용된 pid로 보고 항목을 새로 만든다.
+typedef struct {
+    TopEntry *slots;
+    size_t cap, count;      // cap은 2의 거듭제곱
+} TopTable;
+
+static size_t top_hash(int pid, size_t cap) {
+    return (size_t)((uint32_t)pid * 0x9E3779B1u) & (cap - 1);
+}
+
+// pid의 슬롯을 찾는다. 없으면 넣을 빈 슬롯을 돌려준다.
+static TopEntry *top_slot(TopTable *t, int pid) {
+    size_t i = top_hash(pid, t->cap);
+    while (t->slots[i].pid != 0 && t->slots[i].pid != pid) {
+        i = (i + 1) & (t->cap - 1);
+    }
+    return &t->slots[i];
+}
+
+/**
+ * @brief 슬롯 e를 비운다. (선형 탐사용 뒤쪽 이동 삭제)
+ *
+ * 그냥 0으로 채우면 e 뒤에 같은 탐사 사슬로 들어간 항목을 더는 찾지 못하므로,
+ * 뒤따르는 항목 중 제자리(해시 위치)가 비는 칸 이전인 것을 빈칸으로 당겨 온다.
+ * e의 자원은 미리 놓아 두어야 한다.
+ */
+static void top_slot_remove(TopTable *t, TopEntry *e) {
+    size_t mask = t->cap - 1;
+    size_t hole = (size_t)(e - t->slots);
+    for (size_t j = (hole + 1) & mask; t->slots[j].pid != 0; j = (j + 1) & mask) {
+        size_t home = top_hash(t->slots[j].pid, t->cap);
+        // home이 (hole, j] 밖이면 j의 항목은 hole로 옮겨도 찾을 수 있다.
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            t->slots[hole] = t->slots[j];
+            hole = j;
+        }
+    }
+    memset(&t->slots[hole], 0, sizeof(TopEntry));
+}
+
+static void top_table_alloc(TopTable *t, size_t cap) {
+    t->slots = calloc(cap, sizeof(TopEntry));
+    if (!t->slots) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    t->cap = cap;
+    t->count = 0;
+}
+
+// 항목이 가진 자원(fd, 명령줄)을 놓는다.
+static void top_entry_release(TopEntry *e) {
+    if (e->stat_fd >= 0) close(e->stat_fd);
+    if (e->io_fd >= 0) close(e->io_fd);
+    free(e->cmd);
+}
+
+/**
+ * @brief 항목들을 cap 크기의 새 배열로 옮긴다.
+ * @param keep_tick 0이 아니면 이 틱에 본 항목만 남기고 나머지(끝난 프로세스)는 지운다.
+ */
+static void top_table_rehash(TopTable *t, size_t cap, unsigned long keep_tick) {
+    TopTable fresh;
+    top_table_alloc(&fresh, cap);
+    for (size_t i = 0; i < t->cap; i++) {
+        TopEntry *e = &t->slots[i];
+        if (e->pid == 0) continue;
+        if (keep_tick && e->seen_tick != keep_tick) {
+            top_entry_release(e);
+            continue;
+        }
+        *top_slot(&fresh, e->pid) = *e;
+        fresh.count++;
+    }
+    free(t->slots);
+    *t = fresh;
+}
+
+// 틱이 끝나면 이번에 보이지 않은(끝난) 프로세스를 지우고 크기를 다시 맞춘다.
+static void top_table_sweep(TopTable *t, unsigned long tick) {
+    size_t live = 0;
+    for (size_t i = 0; i < t->cap; i++) {
+        if (t->slots[i].pid != 0 && t->slots[i].seen_tick == tick) live++;
+    }
+    size_t cap = 64;
+    while (cap < live * 2 + 64) cap *= 2;
+    top_table_rehash(t, cap, tick);
+}
+
+static double timespec_seconds(const struct timespec *ts) {
+    return (double)ts->tv_sec + (double)ts->tv_nsec / 1e9;
+}
+
+// 이 프로세스가 지금까지 쓴 CPU 시간 (사용자 + 커널, 초)
+static double self_cpu_seconds(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// 열어 둔 /proc 파일을 처음부터 다시 읽는다. (pread 한 번, 모자라면 버퍼를 늘려 재시도)
+static int proc_pread(int fd, ProcBuf *buf) {
+    for (;;) {
+        if (buf->cap < PROC_BUF_INITIAL) {
+            buf->data = grow_array(buf->data, &buf->cap, PROC_BUF_INITIAL, 1);
+        }
+        ssize_t n = pread(fd, buf->data, buf->cap - 1, 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return -1; // 프로세스가 끝났으면 ESRCH 또는 빈 내용
+        if ((size_t)n < buf->cap - 1) {
+            buf->len = (size_t)n;
+            buf->data[n] = '\0';
             return 0;
         }
+        buf->data = grow_array(buf->data, &buf->cap, buf->cap * 2, 1);
     }
-    return 1;
 }
 
 /**
- * @brief 특정 PID에 대한 주요 정보를 수집하여 ProcessInfo 구조체에 채운다.
- * @param p_info 정보를 채울 ProcessInfo 구조체 포인터
- * @param pid 정보를 가져올 프로세스의 ID (문자열)
- * @return 성공 시 1, 실패 시 0
+ * @brief pid의 파일을 읽는다. fd를 열어 둘 수 있으면 *fd에 남겨 다음 틱에 재사용한다.
+ * @param fd 열어 둔 fd (-1이면 새로 연다. 더 열 수 없으면 -1로 남는다)
  */
-int get_process_info(ProcessInfo *p_info, const char *pid) {
-    char path[256];
-    FILE *fp;
-
-    // --- 1. /proc/<pid>/stat 파일에서 PID, PPID, TTY 정보 가져오기 ---
-    snprintf(path, sizeof(path), STAT_PATH, pid);
-    fp = fopen(path, "r");
-    if (!fp) return 0;
-    
-    // stat 파일은 공백으로 구분된 여러 값을 포함한다. 필요한 값만 파싱한다.
-    // %*s 는 해당 필드를 읽고 무시하라는 의미.
-    fscanf(fp, "%s %*s %*c %s %*d %*d %s",
-           p_info->pid, p_info->ppid, p_info->tty_nr);
-    fclose(fp);
-
-    // --- 2. /proc/<pid>/cmdline 파일에서 명령어 정보 가져오기 ---
-    snprintf(path, sizeof(path), CMDLINE_PATH, pid);
-    fp = fopen(path, "r");
-    if (fp) {
-        size_t len = fread(p_info->cmd, 1, sizeof(p_info->cmd) - 1, fp);
-        p_info->cmd[len] = '\0'; // Null-terminate
-        // cmdline은 인자가 NULL 문자로 구분되어 있으므로 첫 번째 NULL을 공백으로 바꿔준다.
-        for (int i = 0; i < len; i++) {
-            if (p_info->cmd[i] == '\0') p_info->cmd[i] = ' ';
-        }
-        fclose(fp);
-    } else { // cmdline 파일이 없는 경우 (커널 스레드 등)
-        strncpy(p_info->cmd, "[kernel thread]", sizeof(p_info->cmd));
-    }
-
-
-    // --- 3. /proc/<pid>/status 파일에서 UID를 가져와 사용자 이름으로 변환 ---
-    get_username_from_status(pid, p_info->user, sizeof(p_info->user));
-    
-    // TTY 번호를 "pts/0" 같은 이름으로 변환하는 로직은 복잡하여 '?'로 대체
-    if (strcmp(p_info->tty_nr, "0") == 0) {
-        strcpy(p_info->tty_nr, "?");
+static int top_read(int proc_fd, const char *pid_name, const char *file, int *fd, ProcBuf *buf) {
+    if (*fd >= 0) {
+        return proc_pread(*fd, buf);
+    }
+    char path[64];
+    pid_file_path(path, sizeof(path), pid_name, file);
+    int new_fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (new_fd == -1) {
+        return -1;
+    }
+    int ret = proc_pread(new_fd, buf);
+    if (ret == 0) {
+        *fd = new_fd;
     } else {
-        // 실제로는 dev_t major/minor 번호를 tty 이름으로 매핑해야 함
-        strcpy(p_info->tty_nr, "pts/x"); 
+        close(new_fd);
     }
-    
-    return 1;
+    return ret;
 }
 
+// /proc/<pid>/io에서 "key: 값" 줄의 값을 찾는다. 없으면 0.
+static unsigned long long io_field(const char *data, const char *key) {
+    const char *p = strstr(data, key);
+    return p ? strtoull(p + strlen(key), NULL, 10) : 0;
+}
+
+// 처음 보는 프로세스의 소유자를 /proc/<pid> 디렉터리로 확인한다. 보이지 않을 프로세스면
+// hidden과 dir_ino만 채운다.
+static int top_entry_owner(TopEntry *e, int proc_fd, const char *pid_name, const TopOptions *opts) {
+    struct stat dir_st;
+    if (fstatat(proc_fd, pid_name, &dir_st, 0) == -1) {
+        return -1;
+    }
+    e->hidden = !opts->show_all_users && dir_st.st_uid != opts->my_uid;
+    if (e->hidden) {
+        e->dir_ino = dir_st.st_ino;
+    } else {
+        e->user = idcache_user(dir_st.st_uid, NULL);
+    }
+    return 0;
+}
+
+// 처음 보는 (보일) 프로세스의 명령줄을 채운다.
+static int top_entry_init(TopEntry *e, int proc_fd, const char *pid_name, const ProcStat *st,
+                          ProcBuf *buf) {
+    char path[64];
+    size_t len = 0;
+    pid_file_path(path, sizeof(path), pid_name, "cmdline");
+    if (proc_read_file(proc_fd, path, buf) == 0) {
+        len = proc_cmdline_text(buf);
+    }
+    if (len > 0) {
+        e->cmd = strndup(buf->data, len);
+    } else if (asprintf(&e->cmd, "[%s]", st->comm) == -1) {
+        e->cmd = NULL;
+    }
+    if (!e->cmd) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
 
 /**
- * @brief /proc/<pid>/status 파일에서 UID를 읽고, 사용자 이름으로 변환한다.
- * @param pid 프로세스 ID (문자열)
- * @param username_buf 사용자 이름을 저장할 버퍼
- * @param buf_size 버퍼의 크기
+ * @brief /proc을 한 번 훑어 모든 프로세스의 상태를 갱신한다.
+ * @param interval 지난 틱 이후 경과 시간 (초, 첫 틱이면 0)
+ * @return 이번 틱에 본 프로세스 수
  */
-void get_username_from_status(const char *pid, char *username_buf, size_t buf_size) {
-    char path[256], line[256];
-    uid_t uid = -1;
-
-    snprintf(path, sizeof(path), STATUS_PATH, pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
-        strncpy(username_buf, "?", buf_size);
-        return;
+static size_t top_tick(TopTable *t, unsigned long tick, double interval, const TopOptions *opts,
+                       int proc_fd, char *dirent_buf, ProcBuf *buf) {
+    long clk_tck = sysconf(_SC_CLK_TCK);
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    struct timespec boot;
+    clock_gettime(CLOCK_BOOTTIME, &boot); // starttime과 같은 기준 (부팅 후 경과 시간)
+    double uptime = timespec_seconds(&boot);
+    size_t seen = 0;
+
+    lseek(proc_fd, 0, SEEK_SET); // /proc 목록을 처음부터 다시 읽는다.
+    long nread;
+    while ((nread = read_dirents(proc_fd, dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(dirent_buf + off);
+            off += d->d_reclen;
+            if (!is_pid_name(d->d_name)) continue;
+
+            // 테이블이 절반을 넘기 전에 늘린다. (아직 이번 틱에 못 본 항목도 유지)
+            if ((t->count + 1) * 2 > t->cap) {
+                top_table_rehash(t, t->cap * 2, 0);
+            }
+            TopEntry *e = top_slot(t, atoi(d->d_name));
+            ProcStat st;
+
+            // 숨긴 항목은 표시할 열이 없으므로 stat을 읽지 않는다. getdents64가 준 /proc/<pid>의
+            // inode가 같으면 같은 프로세스이다. (pid가 재사용되면 inode가 바뀐다) 소유자는 setuid로
+            // 바뀔 수 있으므로 TOP_OWNER_RECHECK_TICKS 틱에 한 번씩만 fstatat으로 확인한다.
+            // 어느 쪽이든 바뀌었으면 처음 보는 프로세스처럼 새로 시작한다.
+            int is_new = (e->pid == 0);
+            if (!is_new && e->hidden) {
+                int same = d->d_ino == e->dir_ino;
+                if (same && (tick + (unsigned long)e->pid) % TOP_OWNER_RECHECK_TICKS == 0) {
+                    struct stat dir_st;
+                    same = fstatat(proc_fd, d->d_name, &dir_st, 0) == 0 && dir_st.st_ino == e->dir_ino &&
+                           dir_st.st_uid != opts->my_uid;
+                }
+                if (same) {
+                    e->seen_tick = tick;
+                    seen++;
+                    continue;
+                }
+                t->count--;
+                memset(e, 0, sizeof(*e)); // 숨긴 항목은 놓을 자원이 없다.
+                is_new = 1;
+            }
+
+            // 아는 pid면 열어 둔 fd로 stat을 다시 읽는다. 읽기가 실패하거나 starttime이
+            // 다르면 그 프로세스는 끝났고 pid가 재사용된 것이므로 새로 시작한다.
+            if (!is_new) {
+                if (top_read(proc_fd, d->d_name, "stat", &e->stat_fd, buf) == -1 ||
+                    parse_proc_stat(buf->data, buf->len, &st) == -1 ||
+                    st.starttime != e->starttime) {
+                    top_entry_release(e);
+                    t->count--;
+                    memset(e, 0, sizeof(*e)); // 아래에서 다시 채우거나 top_slot_remove로 지운다.
+                    is_new = 1;
+                }
+            }
+            if (is_new) {
+                e->stat_fd = e->io_fd = -1;
+                if (top_entry_owner(e, proc_fd, d->d_name, opts) == -1) {
+                    top_slot_remove(t, e); // 그 사이 끝난 프로세스
+                    continue;
+                }
+                if (e->hidden) {
+                    e->pid = atoi(d->d_name);
+                    e->seen_tick = tick;
+                    t->count++;
+                    seen++;
+                    continue;
+                }
+                if (top_read(proc_fd, d->d_name, "stat", &e->stat_fd, buf) == -1 ||
+                    parse_proc_stat(buf->data, buf->len, &st) == -1 ||
+                    top_entry_init(e, proc_fd, d->d_name, &st, buf) == -1) {
+                    top_entry_release(e); // 그 사이 끝난 프로세스
+                    top_slot_remove(t, e);
+                    continue;
+                }
+                e->pid = st.pid;
+                e->starttime = st.starttime;
+                t->count++;
+            }
+            e->seen_tick = tick;
+            seen++;
+
+            // CPU%: 지난 틱 이후 쓴 CPU 시간 / 경과 시간
+            // 이번 틱에 새로 나타난 프로세스는 시작 이후의 평균으로 계산한다.
+            unsigned long long cpu = st.utime + st.stime;
+            int cpu_moved = is_new || cpu != e->cpu_ticks || st.state == 'R' || st.state == 'D';
+            double cpu_secs, wall;
+            if (is_new) {
+                cpu_secs = (double)cpu / clk_tck;
+                wall = uptime - (double)st.starttime / clk_tck;
+            } else {
+                cpu_secs = (double)(cpu - e->cpu_ticks) / clk_tck;
+                wall = interval;
+            }
+            e->cpu_pct = (wall > 0 && interval > 0) ? cpu_secs / wall * 100.0 : 0.0;
+            e->cpu_ticks = cpu;
+            e->rss_kb = st.rss * page_kb;
+
+            // 입출력량: 읽을 수 없는 프로세스(다른 사용자 등)는 다시 시도하지 않는다.
+            if (e->io_state >= 0 && !cpu_moved) {
+                e->read_rate = e->write_rate = 0; // 쉬고 있는 프로세스
+            } else if (e->io_state >= 0) {
+                if (top_read(proc_fd, d->d_name, "io", &e->io_fd, buf) == -1) {
+                    e->io_state = -1;
+                    e->read_rate = e->write_rate = 0;
+                } else {
+                    unsigned long long rd = io_field(buf->data, "\nread_bytes: ");
+                    unsigned long long wr = io_field(buf->data, "\nwrite_bytes: ");
+                    double span = uptime - e->io_time;
+                    if (e->io_state == 1 && span > 0) {
+                        e->read_rate = (double)(rd - e->read_bytes) / span;
+                        e->write_rate = (double)(wr - e->write_bytes) / span;
+                    } else {
+                        e->read_rate = e->write_rate = 0;
+                    }
+                    e->read_bytes = rd;
+                    e->write_bytes = wr;
+                    e->io_time = uptime;
+                    e->io_state = 1;
+                }
+            }
+        }
     }
-    
-    // "Uid:"로 시작하는 라인을 찾아 UID 값을 파싱한다.
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "Uid:", 4) == 0) {
-            sscanf(line, "Uid:\t%u", &uid);
-            break;
+    if (nread == -1) {
+        perror("getdents64 /proc");
+    }
+    top_table_sweep(t, tick);
+    return seen;
+}
+
+static int top_sort_key;
+
+// 큰 값이 먼저 오도록 정렬하고, 같으면 pid 순으로 둔다.
+static int compare_top(const void *a, const void *b) {
+    const TopEntry *x = *(const TopEntry *const *)a, *y = *(const TopEntry *const *)b;
+    double vx = 0, vy = 0;
+    switch (top_sort_key) {
+        case TOP_SORT_CPU: vx = x->cpu_pct; vy = y->cpu_pct; break;
+        case TOP_SORT_RSS: vx = (double)x->rss_kb; vy = (double)y->rss_kb; break;
+        case TOP_SORT_READ: vx = x->read_rate; vy = y->read_rate; break;
+        case TOP_SORT_WRITE: vx = x->write_rate; vy = y->write_rate; break;
+        case TOP_SORT_PID: break;
+    }
+    if (vx != vy) return vx < vy ? 1 : -1;
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+static void print_rate(double bytes_per_sec, int io_state) {
+    if (io_state < 0) {
+        printf(" %9s", "-");
+    } else {
+        printf(" %9.1f", bytes_per_sec / 1024.0);
+    }
+}
+
+/**
+ * @brief -d 모드의 메인 루프. 화면마다 스냅숏 하나를 만들어 출력한다.
+ *
+ * 화면 맨 위에 이번 스냅숏을 만드는 데 든 CPU 시간과 그것이 갱신 간격에서
+ * 차지하는 비율(코어 하나 기준)을 보여주어 모니터 자신의 부하를 확인할 수 있게 한다.
+ */
+void run_top(const TopOptions *opts, int proc_fd, char *dirent_buf, ProcBuf *buf) {
+    TopTable table;
+    top_table_alloc(&table, 1024);
+    TopEntry **rows = NULL;
+    size_t rows_cap = 0;
+    int is_tty = isatty(STDOUT_FILENO);
+    top_sort_key = opts->sort_key;
+
+    // 프로세스마다 stat/io fd를 열어 두므로 열 수 있는 fd 수를 최대로 올린다.
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    struct timespec prev, now;
+    clock_gettime(CLOCK_BOOTTIME, &prev);
+    top_tick(&table, 1, 0.0, opts, proc_fd, dirent_buf, buf); // 첫 틱은 기준값만 모은다.
+
+    for (int frame = 0; opts->iterations == 0 || frame < opts->iterations; frame++) {
+        unsigned long tick = (unsigned long)frame + 2;
+        struct timespec delay = { (time_t)opts->delay,
+                                  (long)((opts->delay - (double)(time_t)opts->delay) * 1e9) };
+        while (nanosleep(&delay, &delay) == -1 && errno == EINTR) { }
+
+        double cpu_before = self_cpu_seconds();
+        clock_gettime(CLOCK_BOOTTIME, &now);
+        double interval = timespec_seconds(&now) - timespec_seconds(&prev);
+        prev = now;
+
+        size_t total = top_tick(&table, tick, interval, opts, proc_fd, dirent_buf, buf);
+
+        // 보여줄 항목을 모아 정렬한다.
+        size_t nrows = 0;
+        rows = grow_array(rows, &rows_cap, table.count + 1, sizeof(TopEntry *));
+        for (size_t i = 0; i < table.cap; i++) {
+            if (table.slots[i].pid != 0 && !table.slots[i].hidden) rows[nrows++] = &table.slots[i];
+        }
+        qsort(rows, nrows, sizeof(TopEntry *), compare_top);
+
+        double cost = self_cpu_seconds() - cpu_before;
+
+        // 터미널이면 화면을 지우고 높이에 맞춰 자른다.
+        size_t max_rows = nrows;
+        if (is_tty) {
+            struct winsize ws;
+            fputs("\033[H\033[2J", stdout);
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 3 && (size_t)(ws.ws_row - 3) < max_rows) {
+                max_rows = ws.ws_row - 3;
+            }
+        }
+        printf("tasks: %zu  shown: %zu  snapshot cpu: %.2f ms (%.3f%% of one core)\n",
+               total, nrows, cost * 1000.0, interval > 0 ? cost / interval * 100.0 : 0.0);
+        printf("%7s %-8s %6s %10s %9s %9s %s\n", "PID", "USER", "%CPU", "RSS(KB)", "READ KB/s", "WRIT KB/s", "CMD");
+        for (size_t i = 0; i < max_rows; i++) {
+            const TopEntry *e = rows[i];
+            printf("%7d %-8s %6.1f %10lld", e->pid, e->user, e->cpu_pct, e->rss_kb);
+            print_rate(e->read_rate, e->io_state);
+            print_rate(e->write_rate, e->io_state);
+            printf(" %s\n", e->cmd);
         }
+        if (!is_tty) putchar('\n'); // 파일로 저장할 때 화면 사이를 구분한다.
+        fflush(stdout);
     }
-    fclose(fp);
 
-    // UID를 사용자 이름으로 변환한다.
-    struct passwd *pw = getpwuid(uid);
-    if (pw) {
-        strncpy(username_buf, pw->pw_name, buf_size);
-    } else { // 해당 UID의 사용자가 없을 경우
-        snprintf(username_buf, buf_size, "%u", uid); // 그냥 UID 숫자를 쓴다.
+    for (size_t i = 0; i < table.cap; i++) {
+        if (table.slots[i].pid != 0) top_entry_release(&table.slots[i]);
     }
+    free(table.slots);
+    free(rows);
 }
\ No newline at end of file
@@ -1,11 +1,27 @@
+#define _GNU_SOURCE     // for DT_* 상수, O_DIRECTORY
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>     // getopt, unlink, rmdir
-#include <dirent.h>     // opendir, readdir, closedir
-#include <sys/stat.h>   // lstat
+#include <unistd.h>     // getopt, unlink, rmdir, fork
+#include <getopt.h>     // getopt_long (--background, --rate)
+#include <fcntl.h>      // openat, unlinkat, AT_REMOVEDIR
+#include <dirent.h>     // for DT_* 상수
+#include <sys/stat.h>   // lstat, fstatat
 #include <errno.h>      // errno
-#include <limits.h>     // PATH_MAX
+#include <limits.h>     // NAME_MAX
+#include <time.h>       // clock_gettime, nanosleep (--rate)
+#include <sys/file.h>   // flock (휴지통 디렉터리 작업자 하나만)
+#include <sys/wait.h>   // waitpid
+#include <sys/resource.h> // setrlimit (-j에서 여는 디렉터리 fd 수)
+#include "c_walk.h"     // getdents64로 디렉터리 읽기 (c_ls, c_du와 공유)
+#include "c_uring.h"    // io_uring 최소 래퍼 (UNLINKAT 일괄 처리)
+
+// --rate: 백그라운드 작업자의 초당 삭제 연산(unlink, rmdir) 수 제한
+typedef struct {
+    long ops_per_sec;
+    struct timespec start;  // 기준 시각
+    unsigned long ops;      // 기준 시각 이후 연산 수
+} RateLimit;
 
 // --- 옵션 구조체 정의 ---
 // 전역 변수 대신, 프로그램 옵션을 담는 구조체를 사용합니다.
@@ -15,6 +31,9 @@ typedef struct {
     int interactive; // -i: 삭제 전 사용자에게 확인
     int recursive;   // -r, -R: 디렉터리와 그 내용물을 재귀적으로 삭제
     int verbose;     // -v: 삭제되는 파일/디렉터리 목록을 출력
+    int jobs;        // -j N: 하위 트리를 동시에 지울 작업 스레드 수 (1이면 한 스레드로)
+    int background;  // --background: 휴지통으로 옮기기만 하고 삭제는 분리된 작업자에게 맡김
+    RateLimit *rate; // 삭제 연산마다 속도 제한 (NULL이면 제한 없음, 백그라운드 작업자만 씀)
 } RmOptions;
 
 // 함수 선언 (main 함수에서 사용하기 위해 미리 선언)
@@ -43,10 +62,629 @@ int confirm_delete(const char *path, const RmOptions *opts) {
 }
 
 /**
- * @brief 디렉터리와 그 내용물을 재귀적으로 삭제합니다.
+ * @brief 삭제 연산 하나를 하기 전에 부릅니다. 제한보다 앞서 있으면 그만큼 잠듭니다.
+ *
+ * 연산 n번째의 예정 시각을 start + n / ops_per_sec로 두고 그보다 이르면 기다립니다.
+ * 한참 뒤처진 경우(다른 일로 멈춰 있었던 경우)에는 몰아서 따라잡지 않도록 기준을 다시 잡습니다.
+ */
+static void rate_limit_wait(RateLimit *rl) {
+    if (!rl || rl->ops_per_sec <= 0) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (now.tv_sec - rl->start.tv_sec) + (now.tv_nsec - rl->start.tv_nsec) / 1e9;
+    double due = (double)rl->ops / rl->ops_per_sec;
+    if (rl->ops == 0 || elapsed - due > 1.0) {
+        rl->start = now;
+        rl->ops = 0;
+        elapsed = due = 0;
+    }
+    if (due > elapsed) {
+        double wait = due - elapsed;
+        struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+        nanosleep(&ts, NULL);
+    }
+    rl->ops++;
+}
+
+// --- fd 기준 재귀 삭제 ---
+
+// 열어 둘 디렉터리 fd의 최대 수. 더 깊이 내려가면 가장 바깥쪽 fd를 닫았다가 돌아올 때 ".."로 다시 연다.
+#define RM_MAX_OPEN_DIRS 256
+
+// io_uring 링에 한 번에 올려 둘 UNLINKAT 요청 수. 요청마다 이름 복사본(NAME_MAX + 1바이트)이 하나씩 필요하다.
+#define UNLINK_BATCH 512
+
+// 표시용 경로. 오류 메시지와 -v, -i에만 쓰고 시스템 호출에는 쓰지 않으므로 길이 제한이 없습니다.
+typedef struct {
+    char *data;
+    size_t len, cap;
+} PathBuf;
+
+// 이름들을 '\0'으로 구분해 이어 붙인 목록
+typedef struct {
+    char *data;
+    size_t len, cap;
+} NameList;
+
+// 삭제 중인 디렉터리 하나
+typedef struct {
+    int fd;                 // 열린 디렉터리 (-1이면 RM_MAX_OPEN_DIRS 때문에 잠시 닫아 둠)
+    dev_t dev;              // fd를 닫을 때 기록해 두고, ".."로 다시 열 때 같은 디렉터리인지 확인
+    ino_t ino;
+    int scanned;            // 항목을 모두 읽었는지
+    int failed;             // 하위 항목 삭제가 하나라도 실패하면 이 디렉터리는 지우지 않는다
+    NameList pending;       // 아직 들어가지 않은 하위 디렉터리 이름
+    size_t pending_pos;
+    size_t path_saved;      // 이 디렉터리 이름을 경로에 덧붙이기 전의 길이
+} RmFrame;
+
+typedef struct {
+    const RmOptions *opts;
+    RmFrame *frames;        // 명시적 스택 (재귀 호출 대신)
+    size_t depth, cap;
+    size_t lowest_open;     // frames[lowest_open..depth)의 fd가 열려 있다
+    PathBuf path;
+    char *dirent_buf;       // 디렉터리 하나를 끝까지 읽은 뒤에 내려가므로 모두 함께 쓴다
+    Uring ring;
+    int has_ring;           // io_uring 링을 만들었는지
+    int use_ring;           // 파일을 링으로 지울지 (커널이 UNLINKAT을 모르면 0으로 바뀜)
+    char (*slot_names)[NAME_MAX + 1]; // 링에 올라간 요청별 이름. 다음 getdents64가 버퍼를 덮어써도 되도록 복사해 둔다.
+    uint32_t *free_slots;
+    unsigned nfree, inflight;
+} RmWalk;
+
+/**
+ * @brief 작업 버퍼를 준비합니다. io_uring을 쓸 수 있으면 UNLINKAT용 링도 만듭니다.
+ *
+ * 커널이 너무 오래됐거나 seccomp로 막혀 있으면 링 없이 파일마다 unlinkat을 직접 호출합니다.
+ * -i는 항목마다 먼저 물어봐야 하므로 링을 쓰지 않습니다.
+ * 커널은 UNLINKAT 요청을 io-wq 작업 스레드로 넘겨 처리하므로, CPU가 하나뿐이면 겹쳐 실행될
+ * 곳이 없어 넘기는 비용만 늘어납니다. 그래서 CPU가 둘 이상일 때만 링을 씁니다.
+ */
+static void rm_walk_init(RmWalk *w, const RmOptions *opts) {
+    memset(w, 0, sizeof(*w));
+    w->opts = opts;
+    w->dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (!w->dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (!opts->interactive && sysconf(_SC_NPROCESSORS_ONLN) > 1 && uring_init(&w->ring, UNLINK_BATCH) == 0) {
+        w->slot_names = malloc(UNLINK_BATCH * sizeof(*w->slot_names));
+        w->free_slots = malloc(UNLINK_BATCH * sizeof(uint32_t));
+        if (!w->slot_names || !w->free_slots) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < UNLINK_BATCH; i++) w->free_slots[w->nfree++] = UNLINK_BATCH - 1 - i;
+        w->has_ring = w->use_ring = 1;
+    }
+}
+
+static void rm_walk_free(RmWalk *w) {
+    if (w->has_ring) uring_exit(&w->ring);
+    free(w->slot_names);
+    free(w->free_slots);
+    free(w->frames);
+    free(w->path.data);
+    free(w->dirent_buf);
+}
+
+// "/name"을 덧붙이고, 덧붙이기 전의 길이를 돌려준다.
+static size_t path_push(PathBuf *p, const char *name) {
+    size_t saved = p->len, n = strlen(name);
+    p->data = grow_array(p->data, &p->cap, p->len + n + 2, 1);
+    if (p->len > 0 && p->data[p->len - 1] != '/') {
+        p->data[p->len++] = '/';
+    }
+    memcpy(p->data + p->len, name, n + 1);
+    p->len += n;
+    return saved;
+}
+
+static void path_pop(PathBuf *p, size_t saved) {
+    p->len = saved;
+    p->data[saved] = '\0';
+}
+
+static void name_list_add(NameList *list, const char *name) {
+    size_t n = strlen(name) + 1;
+    list->data = grow_array(list->data, &list->cap, list->len + n, 1);
+    memcpy(list->data + list->len, name, n);
+    list->len += n;
+}
+
+/**
+ * @brief 현재 디렉터리의 항목 name을 unlinkat한 결과를 알립니다. (직접 호출과 io_uring이 함께 씀)
+ * @param err 0이면 성공, 아니면 errno 값
+ * @return 성공 시 0, 실패 시 -1
+ *
+ * 경로 문자열은 메시지를 찍을 때만 만듭니다.
+ */
+static int report_unlink(RmWalk *w, const char *name, int err) {
+    const RmOptions *opts = w->opts;
+    if (err == 0 && !opts->verbose) return 0;
+
+    int ret = 0;
+    size_t saved = path_push(&w->path, name);
+    if (err == 0) {
+        printf("removed '%s'\n", w->path.data);
+    } else {
+        // 파일이 존재하지 않는 오류(ENOENT)는 -f 옵션이 있을 때 무시합니다.
+        if (!opts->force || err != ENOENT) {
+            fprintf(stderr, "rm: cannot remove '%s': %s\n", w->path.data, strerror(err));
+        }
+        if (err != ENOENT) ret = -1;
+    }
+    path_pop(&w->path, saved);
+    return ret;
+}
+
+/**
+ * @brief 디렉터리가 아닌 항목 하나를 dirfd 기준으로 지웁니다. (handle_file_removal의 fd 버전)
+ * @return 성공(또는 사용자가 거절) 시 0, 실패 시 -1
+ */
+static int remove_entry(RmWalk *w, int dirfd, const char *name) {
+    if (w->opts->interactive) {
+        size_t saved = path_push(&w->path, name);
+        int yes = confirm_delete(w->path.data, w->opts);
+        path_pop(&w->path, saved);
+        if (!yes) return 0; // 사용자가 'no'를 선택한 경우도 실패는 아님
+    }
+    rate_limit_wait(w->opts->rate);
+    return report_unlink(w, name, unlinkat(dirfd, name, 0) == 0 ? 0 : errno);
+}
+
+// 링에서 완료된 UNLINKAT 결과를 모두 거둬 알린다. 하나라도 실패하면 f->failed를 켠다.
+static void harvest_unlinks(RmWalk *w, RmFrame *f) {
+    struct io_uring_cqe *cqe;
+    while ((cqe = uring_peek_cqe(&w->ring)) != NULL) {
+        uint32_t slot = (uint32_t)cqe->user_data;
+        int res = cqe->res;
+        uring_cqe_seen(&w->ring);
+
+        const char *name = w->slot_names[slot];
+        int ret;
+        if (res == -EINVAL || res == -EOPNOTSUPP) {
+            // 커널이 IORING_OP_UNLINKAT을 모르는 경우(5.11 이전): 이 항목은 직접 지우고 이후로는 링을 쓰지 않는다.
+            w->use_ring = 0;
+            ret = remove_entry(w, f->fd, name);
+        } else {
+            ret = report_unlink(w, name, -res);
+        }
+        if (ret != 0) f->failed = 1;
+        w->free_slots[w->nfree++] = slot;
+        w->inflight--;
+    }
+}
+
+// 쌓인 요청을 제출하고 wait_nr개 이상 끝나길 기다린 뒤 결과를 거둔다.
+static void submit_unlinks(RmWalk *w, RmFrame *f, unsigned wait_nr) {
+    if (uring_submit(&w->ring, wait_nr) == -1 && errno != EINTR) {
+        perror("io_uring_enter");
+        exit(EXIT_FAILURE);
+    }
+    harvest_unlinks(w, f);
+}
+
+// 파일 하나의 UNLINKAT 요청을 링에 올린다. 빈 슬롯이 없으면 하나 이상 끝나길 기다린다.
+static void queue_unlink(RmWalk *w, RmFrame *f, const char *name) {
+    struct io_uring_sqe *sqe = NULL;
+    while (w->nfree == 0 || !(sqe = uring_get_sqe(&w->ring))) {
+        submit_unlinks(w, f, 1);
+        if (!w->use_ring) {
+            // 그 사이 커널이 UNLINKAT을 모른다는 것을 알게 됐다.
+            if (remove_entry(w, f->fd, name) != 0) f->failed = 1;
+            return;
+        }
+    }
+
+    rate_limit_wait(w->opts->rate);
+    uint32_t slot = w->free_slots[--w->nfree];
+    memcpy(w->slot_names[slot], name, strlen(name) + 1);
+    sqe->opcode = IORING_OP_UNLINKAT;
+    sqe->fd = f->fd;
+    sqe->addr = (uint64_t)(uintptr_t)w->slot_names[slot];
+    sqe->unlink_flags = 0;
+    sqe->user_data = slot;
+    w->inflight++;
+}
+
+/**
+ * @brief 디렉터리를 끝까지 읽으며 파일은 바로 지우고, 하위 디렉터리 이름은 pending에 모읍니다.
+ *
+ * 종류는 d_type으로 가르고, d_type을 알려주지 않는 파일 시스템(DT_UNKNOWN)에서만 fstatat을 합니다.
+ * io_uring을 쓸 수 있으면 파일은 UNLINKAT 요청으로 링에 쌓아 두었다가 getdents64 버퍼 하나를
+ * 다 훑을 때마다 제출하므로, 커널이 지우는 동안 다음 버퍼를 읽습니다. 돌아가기 전에 모두 거둡니다.
+ */
+static void scan_directory(RmWalk *w, RmFrame *f) {
+    long nread;
+    while ((nread = read_dirents(f->fd, w->dirent_buf)) > 0) {
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(w->dirent_buf + off);
+            off += d->d_reclen;
+            // 현재 디렉터리(.)와 상위 디렉터리(..)는 건너뜁니다.
+            if (is_dot_or_dotdot(d->d_name)) continue;
+
+            unsigned char type = d->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (fstatat(f->fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    if (errno == ENOENT) continue; // 그 사이 지워졌다
+                    size_t saved = path_push(&w->path, d->d_name);
+                    fprintf(stderr, "rm: cannot access '%s': %s\n", w->path.data, strerror(errno));
+                    path_pop(&w->path, saved);
+                    f->failed = 1;
+                    continue;
+                }
+                type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+            }
+
+            if (type == DT_DIR) {
+                name_list_add(&f->pending, d->d_name);
+            } else if (w->use_ring) {
+                queue_unlink(w, f, d->d_name);
+            } else if (remove_entry(w, f->fd, d->d_name) != 0) {
+                f->failed = 1;
+            }
+        }
+        // 기다리지 않고 제출만 한다. 완료는 다음에 슬롯이 모자랄 때나 마지막에 거둔다.
+        if (w->inflight > 0) submit_unlinks(w, f, 0);
+    }
+    if (nread == -1) {
+        fprintf(stderr, "rm: cannot read directory '%s': %s\n", w->path.data, strerror(errno));
+        f->failed = 1;
+    }
+    while (w->inflight > 0) {
+        submit_unlinks(w, f, 1);
+    }
+}
+
+// 열린 디렉터리 fd를 스택에 올린다.
+static void walk_push(RmWalk *w, int fd, size_t path_saved) {
+    w->frames = grow_array(w->frames, &w->cap, w->depth + 1, sizeof(RmFrame));
+
+    // 열린 fd가 너무 많으면 가장 바깥쪽 것을 닫는다. 다시 열 때 확인할 수 있도록 dev/ino를 기록한다.
+    if (w->depth - w->lowest_open >= RM_MAX_OPEN_DIRS) {
+        RmFrame *outer = &w->frames[w->lowest_open];
+        struct stat st;
+        if (fstat(outer->fd, &st) == 0) {
+            outer->dev = st.st_dev;
+            outer->ino = st.st_ino;
+            close(outer->fd);
+            outer->fd = -1;
+            w->lowest_open++;
+        }
+    }
+
+    RmFrame *f = &w->frames[w->depth++];
+    memset(f, 0, sizeof(*f));
+    f->fd = fd;
+    f->path_saved = path_saved;
+}
+
+/**
+ * @brief 다 비운 맨 위 디렉터리를 닫고 부모 fd 기준으로 지운 뒤 스택에서 내린다.
+ * @return 0, 닫아 두었던 부모를 다시 열 수 없으면(그 사이 옮겨짐) -1
+ */
+static int walk_pop(RmWalk *w) {
+    const RmOptions *opts = w->opts;
+    RmFrame *child = &w->frames[w->depth - 1];
+    RmFrame *parent = &w->frames[w->depth - 2];
+
+    if (parent->fd == -1) {
+        // 닫아 두었던 부모를 자식 기준 ".."로 다시 열고, 같은 디렉터리인지 확인한다.
+        int fd = openat(child->fd, "..", O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) != 0 || st.st_dev != parent->dev || st.st_ino != parent->ino) {
+            path_pop(&w->path, child->path_saved);
+            fprintf(stderr, "rm: directory '%s' was moved during removal\n", w->path.data);
+            if (fd != -1) close(fd);
+            return -1;
+        }
+        parent->fd = fd;
+        w->lowest_open--;
+    }
+
+    close(child->fd);
+    free(child->pending.data);
+    int failed = child->failed;
+    w->depth--;
+
+    // 하위 항목을 모두 지웠을 때만 디렉터리 자체를 지운다.
+    if (!failed && confirm_delete(w->path.data, opts)) {
+        const char *name = w->path.data + child->path_saved;
+        if (*name == '/') name++;
+        rate_limit_wait(opts->rate);
+        if (unlinkat(parent->fd, name, AT_REMOVEDIR) != 0) {
+            if (!opts->force) {
+                fprintf(stderr, "rm: cannot remove directory '%s': %s\n", w->path.data, strerror(errno));
+            }
+            failed = 1;
+        } else if (opts->verbose) {
+            printf("removed directory '%s'\n", w->path.data);
+        }
+    }
+    if (failed) parent->failed = 1;
+    path_pop(&w->path, child->path_saved);
+    return 0;
+}
+
+// --- -j: 여러 스레드로 삭제 ---
+// c_du와 같은 구조입니다. 디렉터리 하나가 작업 하나이고, 작업 스레드는 디렉터리를 읽으며
+// 파일은 바로 지우고 하위 디렉터리는 자식 작업으로 만들어 자신의 덱에 넣습니다.
+// 디렉터리는 자신과 모든 하위 디렉터리가 끝나면(pending이 0이 되면) 마지막으로 끝낸 스레드가
+// 부모 fd 기준으로 지웁니다. 그래서 읽은 디렉터리의 fd는 하위 디렉터리가 모두 끝날 때까지 열어 둡니다.
+
+typedef struct RmNode {
+    struct RmNode *parent;
+    char *name;                 // 부모 기준 이름 (루트는 명령줄 인자)
+    int fd;                     // 읽은 뒤부터 끝날 때까지 열려 있다 (자식들의 openat, unlinkat 기준)
+    int gone;                   // 열려고 보니 없거나 디렉터리가 아니어서 rmdir할 것이 없음
+    atomic_int failed;          // 하위 항목이 하나라도 남으면 이 디렉터리는 지우지 않는다
+    atomic_int pending;         // 끝나지 않은 하위 디렉터리 수 + 1(자기 자신)
+} RmNode;
+
+typedef struct {
+    const RmOptions *opts;
+    WorkDeque *deques;          // 작업 스레드마다 하나
+    int ndeques;
+    pthread_mutex_t lock;       // 아래 조건 변수용
+    pthread_cond_t changed;     // 작업 추가/루트 완료 시 알림
+    unsigned long epoch;        // 알림 누락을 막기 위한 변경 카운터
+    int done;                   // 루트 디렉터리까지 끝났는지
+    int root_failed;
+} RmPool;
+
+typedef struct {
+    RmPool *pool;
+    int index;
+} RmWorkerArg;
+
+static void pool_notify(RmPool *pool, int root_done) {
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch++;
+    if (root_done) pool->done = 1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// 메시지용 경로를 만든다. 아직 끝나지 않은 작업의 조상은 모두 살아 있다.
+// 깊은 트리에서도 재귀하지 않도록 길이를 먼저 재고 뒤에서부터 채운다.
+static void node_path(const RmNode *node, PathBuf *p) {
+    size_t len = strlen(node->name);
+    for (const RmNode *a = node->parent; a; a = a->parent) {
+        len += strlen(a->name) + 1;
+    }
+    p->data = grow_array(p->data, &p->cap, len + 1, 1);
+    p->len = len;
+    p->data[len] = '\0';
+    for (const RmNode *a = node; a; a = a->parent) {
+        size_t n = strlen(a->name);
+        len -= n;
+        memcpy(p->data + len, a->name, n);
+        if (a->parent) p->data[--len] = '/';
+    }
+}
+
+/**
+ * @brief 작업 하나의 몫이 끝났음을 알립니다. 마지막으로 끝난 것이면 디렉터리를 지우고 부모로 올라갑니다.
+ * @param path 메시지용 경로 버퍼 (스레드마다 하나)
+ */
+static void node_release(RmPool *pool, RmNode *node, PathBuf *path) {
+    const RmOptions *opts = pool->opts;
+    while (atomic_fetch_sub(&node->pending, 1) == 1) {
+        RmNode *parent = node->parent;
+        int failed = atomic_load(&node->failed);
+        if (node->fd != -1) close(node->fd);
+
+        // 하위 항목을 모두 지웠을 때만 디렉터리 자체를 지운다.
+        if (!failed && !node->gone) {
+            int rc = parent ? unlinkat(parent->fd, node->name, AT_REMOVEDIR) : rmdir(node->name);
+            int err = errno;
+            if (rc != 0) {
+                if (!opts->force) {
+                    node_path(node, path);
+                    fprintf(stderr, "rm: cannot remove directory '%s': %s\n", path->data, strerror(err));
+                }
+                failed = 1;
+            } else if (opts->verbose) {
+                node_path(node, path);
+                printf("removed directory '%s'\n", path->data);
+            }
+        }
+        free(node->name);
+        free(node);
+
+        if (!parent) {
+            pool->root_failed = failed;
+            pool_notify(pool, 1);
+            return;
+        }
+        if (failed) atomic_store(&parent->failed, 1);
+        node = parent;
+    }
+}
+
+// 디렉터리 하나를 처리한다: 열기, 파일 삭제, 하위 디렉터리 작업 등록
+static void run_node(RmPool *pool, RmNode *node, int deque_index, RmWalk *tw) {
+    const RmOptions *opts = pool->opts;
+
+    if (node->fd == -1) {
+        node->fd = openat(node->parent->fd, node->name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (node->fd == -1) {
+            int err = errno;
+            node->gone = 1;
+            if (err == ENOTDIR || err == ELOOP) {
+                // 읽은 뒤 디렉터리가 아닌 것(심볼릭 링크 등)으로 바뀌었다. 따라가지 않고 그것만 지운다.
+                node_path(node->parent, &tw->path);
+                if (remove_entry(tw, node->parent->fd, node->name) != 0) {
+                    atomic_store(&node->failed, 1);
+                }
+            } else {
+                if (!opts->force || err != ENOENT) {
+                    node_path(node, &tw->path);
+                    fprintf(stderr, "rm: cannot open directory '%s': %s\n", tw->path.data, strerror(err));
+                }
+                if (err != ENOENT) atomic_store(&node->failed, 1);
+            }
+            node_release(pool, node, &tw->path);
+            return;
+        }
+    }
+
+    // 파일은 읽는 즉시 지우고 하위 디렉터리 이름만 모은다. (한 스레드로 지울 때와 같은 함수)
+    RmFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.fd = node->fd;
+    node_path(node, &tw->path);
+    scan_directory(tw, &frame);
+    if (frame.failed) atomic_store(&node->failed, 1);
+
+    size_t nsub = 0;
+    for (size_t pos = 0; pos < frame.pending.len; pos += strlen(frame.pending.data + pos) + 1) {
+        nsub++;
+    }
+    if (nsub > 0) {
+        atomic_fetch_add(&node->pending, (int)nsub);
+        for (size_t pos = 0; pos < frame.pending.len; pos += strlen(frame.pending.data + pos) + 1) {
+            RmNode *child = calloc(1, sizeof(RmNode));
+            if (!child || !(child->name = strdup(frame.pending.data + pos))) {
+                perror("malloc");
+                exit(EXIT_FAILURE);
+            }
+            child->parent = node;
+            child->fd = -1;
+            atomic_init(&child->failed, 0);
+            atomic_init(&child->pending, 1);
+            deque_push(&pool->deques[deque_index], child);
+        }
+        pool_notify(pool, 0);
+    }
+    free(frame.pending.data);
+
+    node_release(pool, node, &tw->path);
+}
+
+static void *worker_main(void *p) {
+    RmWorkerArg *arg = p;
+    RmPool *pool = arg->pool;
+    // 스레드마다 자신의 getdents64 버퍼, 경로 버퍼, io_uring 링을 쓴다.
+    RmWalk tw;
+    rm_walk_init(&tw, pool->opts);
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        unsigned long seen = pool->epoch;
+        int done = pool->done;
+        pthread_mutex_unlock(&pool->lock);
+        if (done) break;
+
+        // 자신의 덱에서 먼저 꺼내고, 비어 있으면 다른 덱에서 훔친다.
+        RmNode *node = deque_pop(&pool->deques[arg->index], 0);
+        for (int i = 1; !node && i < pool->ndeques; i++) {
+            node = deque_pop(&pool->deques[(arg->index + i) % pool->ndeques], 1);
+        }
+        if (node) {
+            run_node(pool, node, arg->index, &tw);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->epoch == seen && !pool->done) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    rm_walk_free(&tw);
+    return NULL;
+}
+
+/**
+ * @brief 열어 둔 루트 디렉터리 아래를 opts->jobs개 스레드로 지우고 루트도 지웁니다.
+ * @param path 루트 디렉터리 경로 (메시지와 마지막 rmdir에 씀)
+ * @param root_fd 루트 디렉터리 fd. 소유권을 넘겨받는다.
+ * @return 성공 시 0, 실패 시 -1
+ *
+ * -v 출력은 항목마다 printf 한 번으로 찍으므로 stdout 잠금 안에서 한 줄씩 나가고,
+ * 여러 스레드의 줄이 섞여 끊기지 않습니다. (줄의 순서는 한 스레드로 지울 때와 다를 수 있음)
+ */
+static int remove_tree_parallel(const char *path, int root_fd, const RmOptions *opts) {
+    // 끝나지 않은 디렉터리마다 fd를 하나씩 쥐고 있으므로, 깊은 트리에서는 기본 한도(1024)를
+    // 넘을 수 있다. 소프트 한도를 하드 한도까지 올려 둔다.
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    RmPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.opts = opts;
+    pool.ndeques = opts->jobs;
+    pool.deques = calloc(pool.ndeques, sizeof(WorkDeque));
+    pthread_t *threads = calloc(opts->jobs, sizeof(pthread_t));
+    RmWorkerArg *args = calloc(opts->jobs, sizeof(RmWorkerArg));
+    RmNode *root = calloc(1, sizeof(RmNode));
+    if (!pool.deques || !threads || !args || !root || !(root->name = strdup(path))) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    for (int i = 0; i < pool.ndeques; i++) {
+        deque_init(&pool.deques[i]);
+    }
+
+    // 끝의 '/'는 떼어 "dir//sub" 같은 경로가 출력되지 않게 한다. ("/" 자체는 유지)
+    size_t len = strlen(root->name);
+    while (len > 1 && root->name[len - 1] == '/') root->name[--len] = '\0';
+    root->fd = root_fd;
+    atomic_init(&root->failed, 0);
+    atomic_init(&root->pending, 1);
+    deque_push(&pool.deques[0], root);
+
+    for (int i = 0; i < opts->jobs; i++) {
+        args[i].pool = &pool;
+        args[i].index = i;
+        if (pthread_create(&threads[i], NULL, worker_main, &args[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < opts->jobs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 0; i < pool.ndeques; i++) {
+        deque_destroy(&pool.deques[i]);
+    }
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.deques);
+    free(threads);
+    free(args);
+    return pool.root_failed ? -1 : 0;
+}
+
+static int remove_tree_at(int parent_fd, const char *name, int root_fd, const char *path, const RmOptions *opts);
+
+/**
+ * @brief 디렉터리와 그 내용물을 삭제합니다. (경로 문자열 대신 디렉터리 fd를 기준으로)
  * @param path 삭제할 디렉터리의 경로
  * @param opts 프로그램 옵션 구조체
  * @return 성공 시 0, 실패 시 -1을 반환합니다.
+ *
+ * 하위 항목마다 "path/name" 경로를 만들어 lstat, unlink하면 시스템 호출마다 커널이
+ * 경로 전체를 처음부터 다시 따라가야 하고, 그 사이 중간 디렉터리가 심볼릭 링크로
+ * 바뀌면 엉뚱한 곳을 지울 수도 있습니다. 여기서는
+ *  - 디렉터리를 openat(O_DIRECTORY | O_NOFOLLOW)로 열어 두고
+ *  - getdents64로 항목을 읽어 d_type으로 파일/디렉터리를 가르고
+ *    (d_type을 알려주지 않는 파일 시스템에서만 fstatat)
+ *  - 파일은 unlinkat(fd, name, 0), 빈 디렉터리는 unlinkat(parent, name, AT_REMOVEDIR)로 지웁니다.
+ * 재귀 호출 대신 RmFrame 스택을 쓰므로 아주 깊은 트리도 C 스택이나 PATH_MAX에 막히지 않습니다.
+ * -j가 2 이상이면 remove_tree_parallel로 하위 트리들을 동시에 지웁니다.
  */
 int handle_directory_removal(const char *path, const RmOptions *opts) {
     // -r 또는 -R 옵션이 없으면 디렉터리를 삭제할 수 없습니다.
@@ -55,56 +693,100 @@ int handle_directory_removal(const char *path, const RmOptions *opts) {
         return -1;
     }
 
-    DIR *dir = opendir(path);
-    if (!dir) {
+    int root_fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (root_fd == -1) {
         // -f 옵션이 켜져 있지 않을 때만 오류를 출력합니다.
         if (!opts->force) {
             fprintf(stderr, "rm: cannot open directory '%s': %s\n", path, strerror(errno));
         }
         return -1;
     }
+    if (opts->jobs > 1) {
+        return remove_tree_parallel(path, root_fd, opts);
+    }
+    return remove_tree_at(AT_FDCWD, path, root_fd, path, opts);
+}
 
-    struct dirent *entry;
-    int overall_result = 0;
-    
-    // 디렉터리 내의 모든 항목을 순회합니다.
-    while ((entry = readdir(dir)) != NULL) {
-        // 현재 디렉터리(.)와 상위 디렉터리(..)는 건너뜁니다.
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
+/**
+ * @brief 열어 둔 디렉터리 root_fd 아래를 모두 지우고, 마지막으로 parent_fd 기준 name을 지웁니다.
+ * @param path 표시용 경로 (메시지와 -v, -i에만 쓴다)
+ * @return 성공 시 0, 실패 시 -1 (root_fd는 항상 닫는다)
+ *
+ * handle_directory_removal은 (AT_FDCWD, 경로)로, 휴지통 작업자는 (휴지통 fd, 항목 이름)으로 부릅니다.
+ */
+static int remove_tree_at(int parent_fd, const char *name, int root_fd, const char *path, const RmOptions *opts) {
+    RmWalk walk;
+    rm_walk_init(&walk, opts);
+    path_push(&walk.path, path);
+    walk_push(&walk, root_fd, 0);
 
-        // 전체 경로를 안전하게 생성합니다. (고정 크기 대신 PATH_MAX 사용)
-        char subpath[PATH_MAX];
-        int len = snprintf(subpath, sizeof(subpath), "%s/%s", path, entry->d_name);
-        if (len >= sizeof(subpath)) {
-            fprintf(stderr, "rm: path is too long: %s/%s\n", path, entry->d_name);
-            overall_result = -1;
-            continue; // 다음 파일로 진행
+    int aborted = 0;
+    while (walk.depth > 0) {
+        RmFrame *f = &walk.frames[walk.depth - 1];
+        if (!f->scanned) {
+            // 파일은 읽는 즉시 지우고 하위 디렉터리 이름만 모아 둔다.
+            scan_directory(&walk, f);
+            f->scanned = 1;
         }
-        
-        // 하위 경로에 대해 재귀적으로 삭제 함수를 호출합니다.
-        if (remove_path(subpath, opts) != 0) {
-            overall_result = -1; // 하나라도 실패하면 최종 결과는 실패
+
+        // 아직 들어가지 않은 하위 디렉터리가 있으면 연다.
+        if (f->pending_pos < f->pending.len) {
+            const char *name = f->pending.data + f->pending_pos;
+            f->pending_pos += strlen(name) + 1;
+            int fd = openat(f->fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd == -1 && (errno == ENOTDIR || errno == ELOOP)) {
+                // 읽은 뒤 디렉터리가 아닌 것(심볼릭 링크 등)으로 바뀌었다. 따라가지 않고 그것만 지운다.
+                if (remove_entry(&walk, f->fd, name) != 0) f->failed = 1;
+            } else if (fd == -1) {
+                int err = errno;
+                size_t saved = path_push(&walk.path, name);
+                if (!opts->force || err != ENOENT) {
+                    fprintf(stderr, "rm: cannot open directory '%s': %s\n", walk.path.data, strerror(err));
+                }
+                if (err != ENOENT) f->failed = 1;
+                path_pop(&walk.path, saved);
+            } else {
+                // 경로는 자식 디렉터리를 다 지운 뒤 walk_pop에서 되돌린다.
+                walk_push(&walk, fd, path_push(&walk.path, name));
+            }
+            continue;
         }
-    }
-    closedir(dir);
 
-    // 하위 내용이 모두 삭제되었거나, 중간에 실패했더라도 디렉터리 자체의 삭제를 시도합니다.
-    if (overall_result == 0) {
-        if (confirm_delete(path, opts)) {
-            if (rmdir(path) != 0) {
-                if (!opts->force) {
-                    fprintf(stderr, "rm: cannot remove directory '%s': %s\n", path, strerror(errno));
+        // 하위 항목을 모두 처리했으므로 이 디렉터리를 부모에서 지운다.
+        if (walk.depth == 1) {
+            close(f->fd);
+            free(f->pending.data);
+            walk.depth--;
+            if (!f->failed) {
+                if (confirm_delete(path, opts)) {
+                    rate_limit_wait(opts->rate);
+                    if (unlinkat(parent_fd, name, AT_REMOVEDIR) != 0) {
+                        if (!opts->force) {
+                            fprintf(stderr, "rm: cannot remove directory '%s': %s\n", path, strerror(errno));
+                        }
+                        f->failed = 1;
+                    } else if (opts->verbose) {
+                        printf("removed directory '%s'\n", path);
+                    }
                 }
-                overall_result = -1;
-            } else if (opts->verbose) {
-                printf("removed directory '%s'\n", path);
             }
+            aborted = f->failed;
+            break;
+        }
+        if (walk_pop(&walk) != 0) {
+            aborted = 1; // 조상 디렉터리를 다시 열 수 없으면 더 진행하지 않는다.
+            break;
         }
     }
-    
-    return overall_result;
+
+    // 중간에 그만둔 경우 남은 fd를 닫는다.
+    while (walk.depth > 0) {
+        RmFrame *f = &walk.frames[--walk.depth];
+        if (f->fd != -1) close(f->fd);
+        free(f->pending.data);
+    }
+    rm_walk_free(&walk);
+    return aborted ? -1 : 0;
 }
 
 /**
@@ -115,6 +797,7 @@ int handle_directory_removal(const char *path, const RmOptions *opts) {
  */
 int handle_file_removal(const char *path, const RmOptions *opts) {
     if (confirm_delete(path, opts)) {
+        rate_limit_wait(opts->rate);
         if (unlink(path) != 0) {
             // 파일이 존재하지 않는 오류(ENOENT)는 -f 옵션이 있을 때 무시합니다.
             if (!opts->force || errno != ENOENT) {
@@ -160,13 +843,405 @@ int remove_path(const char *path, const RmOptions *opts) {
     }
 }
 
+// --- --background: 휴지통으로 옮기고 분리된 작업자가 지우기 ---
+// 대상을 같은 파일 시스템인 "<부모>/.c_rm-trash/" 아래로 renameat2 한 번에 옮기고 바로 돌아갑니다.
+// 실제 삭제는 세션에서 분리된 작업자 프로세스가 --rate 제한에 맞춰 합니다.
+// 휴지통을 만든 디렉터리는 사용자별 목록 파일(TRASH_REGISTRY)에 적어 두고, --background로 실행할
+// 때마다 작업자가 목록의 휴지통을 모두 비웁니다. 그래서 이전 작업자가 끝내지 못하고 남긴 것은
+// 이번에 옮긴 것이 없어도 이어서 지우며, 다 비운 휴지통 디렉터리는 지우고 목록에서도 뺍니다.
+
+#define TRASH_NAME ".c_rm-trash"
+#define TRASH_REGISTRY "c_rm-trash.list"   // $XDG_STATE_HOME (기본 ~/.local/state) 아래
+
+// 작업자가 비울 휴지통 디렉터리들의 절대 경로
+typedef struct {
+    char **paths;
+    size_t count, cap;
+} TrashList;
+
+// abs(malloc한 절대 경로)를 넘겨받아 목록에 더한다. 이미 있으면 버린다.
+static int trash_list_insert(TrashList *list, char *abs) {
+    for (size_t i = 0; i < list->count; i++) {
+        if (strcmp(list->paths[i], abs) == 0) {
+            free(abs);
+            return 0;
+        }
+    }
+    list->paths = grow_array(list->paths, &list->cap, list->count + 1, sizeof(char *));
+    list->paths[list->count++] = abs;
+    return 1;
+}
+
+static void trash_list_free(TrashList *list) {
+    for (size_t i = 0; i < list->count; i++) free(list->paths[i]);
+    free(list->paths);
+    memset(list, 0, sizeof(*list));
+}
+
+/**
+ * @brief 휴지통 목록 파일을 열고 flock을 잡습니다.
+ * @param lock LOCK_SH(읽기) 또는 LOCK_EX(고치기)
+ * @return 잠근 fd, 목록을 둘 곳이 없으면(HOME 없음 등) -1
+ */
+static int trash_registry_open(int lock) {
+    PathBuf path = {0};
+    const char *state = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    if (state && *state == '/') {
+        path_push(&path, state);
+    } else if (home && *home == '/') {
+        // ~/.local/state가 없으면 만든다. (XDG 기본 권한 0700)
+        path_push(&path, home);
+        path_push(&path, ".local");
+        mkdir(path.data, 0700);
+        path_push(&path, "state");
+        mkdir(path.data, 0700);
+    } else {
+        return -1;
+    }
+    path_push(&path, TRASH_REGISTRY);
+    int fd = open(path.data, O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    free(path.data);
+    if (fd != -1 && flock(fd, lock) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// 잠근 목록 파일의 줄(절대 경로)들을 list에 더한다.
+static void trash_registry_read(int fd, TrashList *list) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) return;
+    char *data = malloc(st.st_size + 1);
+    if (!data) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    ssize_t n = pread(fd, data, st.st_size, 0);
+    if (n > 0) {
+        data[n] = '\0';
+        for (char *line = strtok(data, "\n"); line; line = strtok(NULL, "\n")) {
+            if (line[0] != '/') continue;
+            char *abs = strdup(line);
+            if (!abs) {
+                perror("strdup");
+                exit(EXIT_FAILURE);
+            }
+            trash_list_insert(list, abs);
+        }
+    }
+    free(data);
+}
+
+// 새 휴지통을 목록 파일에 적는다. 이미 있으면 그대로 둔다.
+static void trash_registry_add(const char *trash_path) {
+    int fd = trash_registry_open(LOCK_EX);
+    if (fd == -1) return;
+    TrashList known = {0};
+    trash_registry_read(fd, &known);
+    char *abs = strdup(trash_path);
+    if (abs && trash_list_insert(&known, abs)) {
+        // 목록 파일은 잠근 채 고치므로 O_APPEND 없이 끝에 써도 된다.
+        off_t end = lseek(fd, 0, SEEK_END);
+        size_t len = strlen(trash_path);
+        if (end != -1 && (pwrite(fd, trash_path, len, end) != (ssize_t)len ||
+                          pwrite(fd, "\n", 1, end + len) != 1)) {
+            perror("rm: " TRASH_REGISTRY);
+        }
+    }
+    trash_list_free(&known);
+    close(fd);
+}
+
+// 목록 파일에서 더는 없는 휴지통(다 비워 지운 것)을 뺀다.
+static void trash_registry_prune(void) {
+    int fd = trash_registry_open(LOCK_EX);
+    if (fd == -1) return;
+    TrashList known = {0};
+    trash_registry_read(fd, &known);
+    PathBuf out = {0};
+    for (size_t i = 0; i < known.count; i++) {
+        struct stat st;
+        if (lstat(known.paths[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            size_t n = strlen(known.paths[i]);
+            out.data = grow_array(out.data, &out.cap, out.len + n + 1, 1);
+            memcpy(out.data + out.len, known.paths[i], n);
+            out.len += n;
+            out.data[out.len++] = '\n';
+        }
+    }
+    if (ftruncate(fd, 0) != 0 || (out.len > 0 && pwrite(fd, out.data, out.len, 0) != (ssize_t)out.len)) {
+        perror("rm: " TRASH_REGISTRY);
+    }
+    free(out.data);
+    trash_list_free(&known);
+    close(fd);
+}
+
+/**
+ * @brief 부모 디렉터리의 휴지통을 엽니다. 내 것이 아니면 쓰지 않습니다.
+ * @param parent_fd 휴지통이 있는(만들) 디렉터리
+ * @param create 없으면 만들지
+ * @return 휴지통 fd, 없거나 믿을 수 없으면 -1 (남의 것이면 errno = EPERM)
+ *
+ * /tmp처럼 여럿이 쓰는 디렉터리에서는 다른 사용자가 .c_rm-trash를 미리 만들어 둘 수 있습니다.
+ * 그런 휴지통 안의 것은 그 사용자가 바꿔치기(예: 심볼릭 링크)할 수 있으므로, 내 소유이고
+ * 그룹과 다른 사용자에게 쓰기 권한이 없는 디렉터리만 휴지통으로 씁니다.
+ */
+static int open_trash_dir(int parent_fd, int create) {
+    if (create && mkdirat(parent_fd, TRASH_NAME, 0700) != 0 && errno != EEXIST) return -1;
+    int fd = openat(parent_fd, TRASH_NAME, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        close(fd);
+        errno = EPERM;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief 대상을 부모 디렉터리의 휴지통으로 옮깁니다.
+ * @param trash 옮겼으면 그 휴지통을 여기에 더한다
+ * @return 옮겼으면 0, 옮길 수 없으면 -1 (호출자가 평소처럼 바로 지운다)
+ *
+ * 대상이 없거나, -r 없이 디렉터리이거나, 마운트 지점이라 다른 파일 시스템으로는
+ * 옮길 수 없는(EXDEV, EBUSY) 경우, 휴지통이 내 것이 아닌 경우 등은 모두 -1을 돌려주어
+ * remove_path가 평소의 메시지와 함께 처리하게 합니다.
+ */
+static int move_to_trash(const char *path, const RmOptions *opts, TrashList *trash) {
+    struct stat st;
+    if (lstat(path, &st) != 0 || (S_ISDIR(st.st_mode) && !opts->recursive)) return -1;
+
+    // 끝의 '/'를 떼고 부모 경로와 이름으로 나눈다.
+    size_t len = strlen(path);
+    while (len > 1 && path[len - 1] == '/') len--;
+    char *source = strndup(path, len);
+    char *split = strndup(path, len);
+    if (!source || !split) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    char *slash = strrchr(split, '/');
+    const char *parent = ".", *name = split;
+    if (slash) {
+        *slash = '\0';
+        parent = slash == split ? "/" : split;
+        name = slash + 1;
+    }
+
+    int ret = -1;
+    PathBuf trash_path = {0};
+    path_push(&trash_path, parent);
+    path_push(&trash_path, TRASH_NAME);
+    int parent_fd = -1;
+    if (*name && !is_dot_or_dotdot(name) &&
+        (parent_fd = open(parent, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) != -1) {
+        // 작업자가 다 비운 휴지통을 막 지웠다면(옮기기가 ENOENT, 휴지통의 링크 수 0) 새로 만들어 다시 한다.
+        for (int attempt = 0; attempt < 3 && ret != 0; attempt++) {
+            int trash_fd = open_trash_dir(parent_fd, 1);
+            if (trash_fd == -1) {
+                if (errno == EPERM && !opts->force) {
+                    fprintf(stderr, "rm: '%s' is not owned by you or is writable by others; removing '%s' now\n",
+                            trash_path.data, path);
+                }
+                break;
+            }
+            // 이전 작업자가 남긴 같은 이름이 있을 수 있으므로 겹치지 않는 이름을 고른다.
+            char dest[NAME_MAX + 1];
+            int err = 0;
+            for (unsigned n = 0; n < 1000; n++) {
+                snprintf(dest, sizeof(dest), "%.200s.%ld.%u", name, (long)getpid(), n);
+                if (renameat2(AT_FDCWD, source, trash_fd, dest, RENAME_NOREPLACE) == 0) {
+                    ret = 0;
+                    break;
+                }
+                err = errno;
+                if (err != EEXIST) break;
+            }
+            struct stat tst;
+            int trash_gone = ret != 0 && err == ENOENT && fstat(trash_fd, &tst) == 0 && tst.st_nlink == 0;
+            close(trash_fd);
+            if (ret == 0) {
+                if (opts->verbose) printf("moved '%s' to '%s/%s'\n", path, trash_path.data, dest);
+                char *abs = realpath(trash_path.data, NULL); // 작업자는 chdir("/")하므로 절대 경로로 바꿔 둔다.
+                if (abs) {
+                    trash_registry_add(abs);
+                    trash_list_insert(trash, abs);
+                }
+            }
+            if (!trash_gone) break;
+        }
+        close(parent_fd);
+    }
+
+    free(trash_path.data);
+    free(source);
+    free(split);
+    return ret;
+}
+
+/**
+ * @brief 휴지통 안의 항목 하나를 휴지통 fd 기준으로 지웁니다.
+ * @param path 표시용 경로
+ * @return 지웠으면(또는 이미 없으면) 0, 아니면 -1
+ *
+ * 경로 문자열을 다시 따라가지 않으므로, 목록을 읽은 뒤 누가 경로 중간을 심볼릭 링크로
+ * 바꿔도 휴지통 밖을 지우지 않습니다.
+ */
+static int remove_trash_entry(int trash_fd, const char *name, const char *path, const RmOptions *opts) {
+    struct stat st;
+    if (fstatat(trash_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) return errno == ENOENT ? 0 : -1;
+    if (S_ISDIR(st.st_mode)) {
+        int fd = openat(trash_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) return errno == ENOENT ? 0 : -1;
+        return remove_tree_at(trash_fd, name, fd, path, opts);
+    }
+    rate_limit_wait(opts->rate);
+    return (unlinkat(trash_fd, name, 0) == 0 || errno == ENOENT) ? 0 : -1;
+}
+
+/**
+ * @brief 휴지통 디렉터리 하나를 비우고, 다 비웠으면 휴지통 디렉터리도 지웁니다.
+ *
+ * 같은 휴지통을 맡은 작업자가 이미 돌고 있으면 flock으로 그것이 끝나길 기다렸다가,
+ * 그동안 새로 옮겨진 것까지 이어서 지웁니다. 목록을 다 읽은 뒤에 지우고 다시 읽기를
+ * 반복하며, 한 바퀴 동안 하나도 지우지 못하면(권한 등) 남은 것은 다음 실행에 맡깁니다.
+ */
+static void empty_trash(const char *trash_path, const RmOptions *opts) {
+    // 부모를 열고 휴지통은 그 fd 기준으로 (심볼릭 링크를 따라가지 않고) 연다.
+    char *parent = strdup(trash_path);
+    if (!parent) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    char *slash = strrchr(parent, '/');
+    if (!slash || strcmp(slash + 1, TRASH_NAME) != 0) { // 목록 파일이 망가진 경우
+        free(parent);
+        return;
+    }
+    if (slash == parent) slash++;
+    *slash = '\0';
+    int parent_fd = open(parent, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    free(parent);
+    if (parent_fd == -1) return;
+    int fd = open_trash_dir(parent_fd, 0);
+    if (fd == -1 || flock(fd, LOCK_EX) != 0) {
+        if (fd != -1) close(fd);
+        close(parent_fd);
+        return;
+    }
+
+    char *dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (!dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    NameList names = {0};
+    PathBuf path = {0};
+    for (;;) {
+        names.len = 0;
+        lseek(fd, 0, SEEK_SET);
+        long nread;
+        while ((nread = read_dirents(fd, dirent_buf)) > 0) {
+            for (long off = 0; off < nread; ) {
+                struct linux_dirent64 *d = (struct linux_dirent64 *)(dirent_buf + off);
+                off += d->d_reclen;
+                if (!is_dot_or_dotdot(d->d_name)) name_list_add(&names, d->d_name);
+            }
+        }
+        if (names.len == 0) {
+            // 다 비웠다. 그 이름이 아직 이 휴지통일 때만 지운다. (그 사이 새로 옮겨졌으면 ENOTEMPTY로 남는다)
+            struct stat st, cur;
+            if (fstat(fd, &st) == 0 && fstatat(parent_fd, TRASH_NAME, &cur, AT_SYMLINK_NOFOLLOW) == 0 &&
+                st.st_dev == cur.st_dev && st.st_ino == cur.st_ino) {
+                unlinkat(parent_fd, TRASH_NAME, AT_REMOVEDIR);
+            }
+            break;
+        }
+
+        int removed = 0;
+        for (size_t pos = 0; pos < names.len; pos += strlen(names.data + pos) + 1) {
+            path.len = 0;
+            path_push(&path, trash_path);
+            path_push(&path, names.data + pos);
+            if (remove_trash_entry(fd, names.data + pos, path.data, opts) == 0) removed++;
+        }
+        if (removed == 0) break;
+    }
+
+    free(names.data);
+    free(path.data);
+    free(dirent_buf);
+    close(fd); // flock도 함께 풀린다.
+    close(parent_fd);
+}
+
+/**
+ * @brief 휴지통들을 비울 작업자를 세션에서 분리해 띄우고 바로 돌아옵니다.
+ * @param ops_per_sec 작업자의 초당 삭제 연산 수 (0이면 제한 없음)
+ *
+ * 두 번 fork하여 손자가 일하게 하므로 호출자는 기다리지 않고, 작업자는 init에 입양되어
+ * 좀비로 남지 않습니다. 작업자는 -f처럼 조용히, 한 스레드로 지웁니다.
+ */
+static void spawn_trash_worker(const TrashList *trash, long ops_per_sec) {
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork"); // 옮겨 둔 것은 다음 --background 실행이 지운다.
+        return;
+    }
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+
+    // 자식: 새 세션을 만들고 한 번 더 fork한 뒤 바로 끝난다.
+    setsid();
+    if (fork() != 0) _exit(EXIT_SUCCESS);
+
+    // 손자: 터미널과 표준 입출력, 현재 디렉터리를 놓는다.
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd != -1) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (null_fd > STDERR_FILENO) close(null_fd);
+    }
+    if (chdir("/") != 0) _exit(EXIT_FAILURE);
+
+    RateLimit rate = {0};
+    rate.ops_per_sec = ops_per_sec;
+    RmOptions worker = {0};
+    worker.force = 1;
+    worker.recursive = 1;
+    worker.jobs = 1;        // 속도 제한 상태를 스레드 사이에 나누지 않는다.
+    worker.rate = &rate;
+    for (size_t i = 0; i < trash->count; i++) {
+        empty_trash(trash->paths[i], &worker);
+    }
+    trash_registry_prune();
+    _exit(EXIT_SUCCESS);
+}
+
 int main(int argc, char *argv[]) {
     // 옵션 구조체를 0으로 초기화 (모든 플래그를 false로 설정)
     RmOptions options = {0};
+    options.jobs = 1;
+    long rate_ops = 0; // --rate
     int opt;
 
-    // POSIX 표준인 getopt를 사용하여 커맨드 라인 옵션을 파싱합니다.
-    while ((opt = getopt(argc, argv, "firRv")) != -1) {
+    static const struct option long_opts[] = {
+        {"background", no_argument, NULL, 'b'},
+        {"rate", required_argument, NULL, 'l'},
+        {NULL, 0, NULL, 0}
+    };
+
+    // getopt_long을 사용하여 커맨드 라인 옵션을 파싱합니다.
+    while ((opt = getopt_long(argc, argv, "firRvj:", long_opts, NULL)) != -1) {
         switch (opt) {
             case 'f':
                 options.force = 1;
@@ -182,12 +1257,37 @@ int main(int argc, char *argv[]) {
             case 'v':
                 options.verbose = 1;
                 break;
+            case 'j':
+                options.jobs = atoi(optarg);
+                if (options.jobs < 1) {
+                    fprintf(stderr, "rm: invalid number of jobs: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b':
+                options.background = 1;
+                break;
+            case 'l': {
+                char *end;
+                rate_ops = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || rate_ops < 0) {
+                    fprintf(stderr, "rm: invalid rate: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
             default: // 알 수 없는 옵션
-                fprintf(stderr, "Usage: %s [-firRv] file...\n", argv[0]);
+                fprintf(stderr, "Usage: %s [-firRv] [-j N] [--background [--rate OPS]] file...\n", argv[0]);
                 return EXIT_FAILURE;
         }
     }
 
+    // -i는 항목마다 터미널에서 답을 받아야 하므로 여러 스레드나 백그라운드로 지우지 않습니다.
+    if (options.interactive) {
+        options.jobs = 1;
+        options.background = 0;
+    }
+
     // 옵션 파싱 후, 파일 인자가 하나도 없는 경우
     if (optind >= argc) {
         // -f 옵션이 있을 때는 실제 rm처럼 아무 메시지도 출력하지 않습니다.
@@ -199,12 +1299,27 @@ int main(int argc, char *argv[]) {
     }
 
     int exit_status = EXIT_SUCCESS;
+    TrashList trash = {0};
     // 옵션이 아닌, 실제 파일/디렉터리 인자들을 순회합니다.
     for (int i = optind; i < argc; i++) {
+        // --background: 휴지통으로 옮겼으면 끝. 옮길 수 없는 것은 평소처럼 바로 지웁니다.
+        if (options.background && move_to_trash(argv[i], &options, &trash) == 0) {
+            continue;
+        }
         if (remove_path(argv[i], &options) != 0) {
             exit_status = EXIT_FAILURE; // 한 번이라도 실패하면, 프로그램은 실패 코드로 종료
         }
     }
+    if (options.background) {
+        // 지난 실행들이 남긴 휴지통도 함께 맡긴다. (이번에 옮긴 것이 없어도)
+        int registry = trash_registry_open(LOCK_SH);
+        if (registry != -1) {
+            trash_registry_read(registry, &trash);
+            close(registry);
+        }
+        if (trash.count > 0) spawn_trash_worker(&trash, rate_ops);
+    }
+    trash_list_free(&trash);
 
     return exit_status;
 }
\ No newline at end of file
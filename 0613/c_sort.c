@@ -1,7 +1,16 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <getopt.h>     // getopt_long (--csv)
+#include <stdint.h>     // uint64_t 비트마스크
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap (--csv 입력 전체 매핑)
+#include <sys/stat.h>   // fstat
+#ifdef __SSE2__
+#include <emmintrin.h>  // SSE2: 16바이트 단위 문자 비교
+#endif
 
 // --- 구조체 및 상수 정의 ---
 
@@ -12,8 +21,18 @@ typedef struct {
     int numeric;        // -n: 숫자 기준으로 정렬
     int reverse;        // -r: 역순으로 정렬
     int unique;         // -u: 중복된 라인 제거
+    int csv;            // --csv: RFC 4180 레코드 단위로 분리하고 따옴표 안의 구분자는 무시
 } SortOptions;
 
+// --csv 모드에서 레코드 하나를 가리키는 구조체.
+// 입력 버퍼를 복사하지 않고 레코드와 키 필드의 위치(포인터 + 길이)만 기억합니다.
+typedef struct {
+    const char *rec;    // 레코드 시작 (입력 버퍼 내부)
+    size_t rec_len;     // 줄바꿈을 포함한 레코드 길이
+    const char *key;    // 비교 대상(-k 필드 또는 레코드 전체) 시작
+    size_t key_len;     // 비교 대상 길이 (줄바꿈/구분자 제외)
+} CsvRecord;
+
 // C 표준 qsort는 컨텍스트 포인터를 전달할 수 없으므로,
 // 비교 함수가 접근할 수 있도록 옵션을 담는 정적(static) 전역 인스턴스를 사용합니다.
 // 이는 여러 개의 전역 변수를 사용하는 것보다 훨씬 깔끔하고 관리하기 좋은 절충안입니다.
@@ -21,6 +40,7 @@ static SortOptions g_opts;
 
 // --- 함수 선언 ---
 int compare_lines(const void *a, const void *b);
+int compare_csv_records(const void *a, const void *b);
 
 
 /**
@@ -63,6 +83,302 @@ void get_field_from_line(char *dest, size_t dest_size, const char *line, int key
 }
 
 
+// --- --csv 모드: 비트마스크 기반 토크나이저 ---
+
+// 한 번에 검사하는 블록 크기. 블록 안의 각 바이트가 64비트 마스크의 한 비트에 대응합니다.
+#define CSV_BLOCK 64
+
+/**
+ * @brief 64바이트 블록에서 따옴표, 구분자, 줄바꿈 문자의 위치를 비트마스크로 구합니다.
+ *        SSE2가 있으면 16바이트씩 한 번에 비교하고, 없으면 바이트 단위로 계산합니다.
+ */
+static void csv_scan_block(const char *p, char delimiter,
+                           uint64_t *quote, uint64_t *delim, uint64_t *newline) {
+#ifdef __SSE2__
+    const __m128i vq = _mm_set1_epi8('"');
+    const __m128i vd = _mm_set1_epi8(delimiter);
+    const __m128i vn = _mm_set1_epi8('\n');
+    uint64_t q = 0, d = 0, n = 0;
+    for (int i = 0; i < CSV_BLOCK; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        q |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vq)) << i;
+        d |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vd)) << i;
+        n |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vn)) << i;
+    }
+    *quote = q; *delim = d; *newline = n;
+#else
+    uint64_t q = 0, d = 0, n = 0;
+    for (int i = 0; i < CSV_BLOCK; i++) {
+        q |= (uint64_t)(p[i] == '"') << i;
+        d |= (uint64_t)(p[i] == delimiter) << i;
+        n |= (uint64_t)(p[i] == '\n') << i;
+    }
+    *quote = q; *delim = d; *newline = n;
+#endif
+}
+
+/**
+ * @brief 따옴표 마스크의 누적 XOR을 구해 "따옴표 안" 구간을 1로 표시합니다.
+ *        ""(이스케이프된 따옴표)는 두 번 토글되므로 별도 처리가 필요 없습니다.
+ */
+static uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// 레코드 배열에 새 레코드를 추가합니다. 용량이 부족하면 2배로 늘립니다.
+static CsvRecord *csv_push(CsvRecord **recs, size_t *count, size_t *capacity) {
+    if (*count >= *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 1024;
+        CsvRecord *grown = realloc(*recs, *capacity * sizeof(CsvRecord));
+        if (!grown) {
+            perror("Failed to reallocate memory");
+            exit(EXIT_FAILURE);
+        }
+        *recs = grown;
+    }
+    return &(*recs)[(*count)++];
+}
+
+// 키 필드의 끝을 확정합니다. CRLF 줄 끝의 '\r'은 비교 대상에서 제외합니다.
+static void csv_close_key(CsvRecord *r, const char *end) {
+    if (end > r->key && end[-1] == '\r') end--;
+    r->key_len = end - r->key;
+}
+
+/**
+ * @brief 입력 버퍼 전체를 한 번 훑어 레코드 경계와 키 필드 위치를 동시에 찾습니다.
+ *        따옴표 안의 줄바꿈은 레코드 경계가 아니므로 레코드가 여러 줄에 걸칠 수 있습니다.
+ * @param buf 입력 버퍼
+ * @param len 입력 길이
+ * @param out_count 찾은 레코드 수를 저장할 포인터
+ * @return 레코드 배열 (호출자가 free)
+ */
+CsvRecord *split_csv_records(const char *buf, size_t len, size_t *out_count) {
+    CsvRecord *recs = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t in_quote = 0;     // 이전 블록이 따옴표 안에서 끝났으면 모든 비트가 1
+    int field = 1;             // 현재 레코드에서 몇 번째 필드인지
+    int key = g_opts.sort_key;
+    char tail[CSV_BLOCK];      // 마지막 불완전 블록을 읽기 위한 패딩 버퍼
+
+    if (len == 0) {
+        *out_count = 0;
+        return NULL;
+    }
+
+    CsvRecord *cur = csv_push(&recs, &count, &capacity);
+    cur->rec = cur->key = buf;
+    cur->key_len = (size_t)-1; // 아직 키 필드의 끝을 찾지 못함
+
+    for (size_t base = 0; base < len; base += CSV_BLOCK) {
+        const char *p = buf + base;
+        size_t avail = len - base;
+        if (avail < CSV_BLOCK) {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, p, avail);
+            p = tail;
+        }
+
+        uint64_t quote, delim, newline;
+        csv_scan_block(p, g_opts.delimiter, &quote, &delim, &newline);
+
+        // 따옴표 안 구간을 계산하고, 그 밖에 있는 구분자/줄바꿈만 구조 문자로 취급
+        uint64_t quoted = prefix_xor(quote) ^ in_quote;
+        in_quote = (uint64_t)((int64_t)quoted >> 63);
+        uint64_t structural = (delim | newline) & ~quoted;
+        if (avail < CSV_BLOCK) structural &= ((uint64_t)1 << avail) - 1;
+
+        // 구조 문자만 하나씩 방문 (일반 문자는 비트 연산으로 한꺼번에 건너뜀)
+        while (structural) {
+            int bit = __builtin_ctzll(structural);
+            structural &= structural - 1;
+            const char *at = buf + base + bit;
+
+            if ((newline >> bit) & 1) {
+                // 레코드 끝: 키가 마지막 필드였다면 여기서 닫는다.
+                if (cur->key_len == (size_t)-1) {
+                    if (field >= key) csv_close_key(cur, at);
+                    else cur->key_len = 0, cur->key = at; // 필드가 모자라면 빈 키
+                }
+                cur->rec_len = at + 1 - cur->rec;
+                if (base + bit + 1 >= len) {
+                    *out_count = count;
+                    return recs;
+                }
+                cur = csv_push(&recs, &count, &capacity);
+                cur->rec = cur->key = at + 1;
+                cur->key_len = (size_t)-1;
+                field = 1;
+            } else {
+                // 필드 경계: 키 필드의 시작과 끝을 기록
+                if (key > 0) {
+                    if (field == key) csv_close_key(cur, at);
+                    else if (field == key - 1) cur->key = at + 1;
+                }
+                field++;
+            }
+        }
+    }
+
+    // 마지막 레코드에 줄바꿈이 없는 경우
+    if (cur->key_len == (size_t)-1) {
+        if (field >= key) csv_close_key(cur, buf + len);
+        else cur->key_len = 0, cur->key = buf + len;
+    }
+    cur->rec_len = buf + len - cur->rec;
+    *out_count = count;
+    return recs;
+}
+
+/**
+ * @brief 복사 없이 두 CSV 필드를 비교합니다. 바깥 따옴표를 벗기고 ""는 "로 해석합니다.
+ */
+int compare_csv_fields(const char *a, size_t alen, const char *b, size_t blen) {
+    // 둘 다 따옴표가 없는 평범한 필드라면 memcmp 한 번으로 끝낸다.
+    if ((alen == 0 || a[0] != '"') && (blen == 0 || b[0] != '"')) {
+        size_t n = alen < blen ? alen : blen;
+        int r = memcmp(a, b, n);
+        if (r != 0) return r;
+        return (alen > blen) - (alen < blen);
+    }
+
+    const char *ae = a + alen, *be = b + blen;
+    int aq = 0, bq = 0;
+    if (a < ae && *a == '"') { aq = 1; a++; }
+    if (b < be && *b == '"') { bq = 1; b++; }
+    for (;;) {
+        int ca = -1, cb = -1; // -1은 필드의 끝
+        if (a < ae) {
+            if (aq && *a == '"') {
+                if (a + 1 < ae && a[1] == '"') { ca = '"'; a += 2; }
+                else a = ae; // 닫는 따옴표
+            } else {
+                ca = (unsigned char)*a++;
+            }
+        }
+        if (b < be) {
+            if (bq && *b == '"') {
+                if (b + 1 < be && b[1] == '"') { cb = '"'; b += 2; }
+                else b = be;
+            } else {
+                cb = (unsigned char)*b++;
+            }
+        }
+        if (ca != cb) return ca < cb ? -1 : 1;
+        if (ca == -1) return 0;
+    }
+}
+
+// --csv -n: 필드 앞의 따옴표를 건너뛰고 숫자로 해석합니다.
+static double csv_field_number(const char *p, size_t len) {
+    char num[64];
+    if (len > 0 && *p == '"') { p++; len--; }
+    if (len >= sizeof(num)) len = sizeof(num) - 1;
+    memcpy(num, p, len);
+    num[len] = '\0';
+    return atof(num);
+}
+
+/**
+ * @brief --csv 모드에서 qsort에 사용될 비교 함수. compare_lines와 같은 규칙을 따릅니다.
+ */
+int compare_csv_records(const void *a, const void *b) {
+    const CsvRecord *r1 = a;
+    const CsvRecord *r2 = b;
+
+    int cmp_result;
+    if (g_opts.numeric) {
+        double num1 = csv_field_number(r1->key, r1->key_len);
+        double num2 = csv_field_number(r2->key, r2->key_len);
+        if (num1 < num2) cmp_result = -1;
+        else if (num1 > num2) cmp_result = 1;
+        else cmp_result = 0;
+    } else if (g_opts.sort_key > 0) {
+        cmp_result = compare_csv_fields(r1->key, r1->key_len, r2->key, r2->key_len);
+    } else {
+        // -k가 없으면 키는 레코드 전체이므로 따옴표를 벗기지 않고 바이트 그대로 비교한다.
+        // (compare_csv_fields는 첫 필드의 닫는 따옴표에서 멈추므로 "a",z와 "a",b를 같다고 본다)
+        size_t n = r1->key_len < r2->key_len ? r1->key_len : r2->key_len;
+        cmp_result = memcmp(r1->key, r2->key, n);
+        if (cmp_result == 0) cmp_result = (r1->key_len > r2->key_len) - (r1->key_len < r2->key_len);
+    }
+
+    return g_opts.reverse ? -cmp_result : cmp_result;
+}
+
+/**
+ * @brief --csv 모드 전체 흐름: 입력을 통째로 매핑한 뒤 레코드 단위로 정렬하여 출력합니다.
+ *        정규 파일은 mmap으로, 파이프 등은 read로 한 버퍼에 모읍니다.
+ * @param fd 입력 파일 디스크립터
+ */
+void sort_csv(int fd) {
+    struct stat st;
+    char *buf = NULL;
+    size_t len = 0;
+    int mapped = 0;
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        len = st.st_size;
+        buf = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buf == MAP_FAILED) {
+            perror("mmap");
+            exit(EXIT_FAILURE);
+        }
+        madvise(buf, len, MADV_SEQUENTIAL);
+        mapped = 1;
+    } else {
+        size_t capacity = 1 << 16;
+        buf = malloc(capacity);
+        if (!buf) {
+            perror("Failed to allocate memory");
+            exit(EXIT_FAILURE);
+        }
+        ssize_t n;
+        while ((n = read(fd, buf + len, capacity - len)) > 0) {
+            len += n;
+            if (len == capacity) {
+                capacity *= 2;
+                char *grown = realloc(buf, capacity);
+                if (!grown) {
+                    perror("Failed to reallocate memory");
+                    exit(EXIT_FAILURE);
+                }
+                buf = grown;
+            }
+        }
+        if (n < 0) {
+            perror("read");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t count;
+    CsvRecord *recs = split_csv_records(buf, len, &count);
+    qsort(recs, count, sizeof(CsvRecord), compare_csv_records);
+
+    for (size_t i = 0; i < count; i++) {
+        if (g_opts.unique && i > 0 && compare_csv_records(&recs[i - 1], &recs[i]) == 0) {
+            continue;
+        }
+        fwrite(recs[i].rec, 1, recs[i].rec_len, stdout);
+        // 줄바꿈 없이 끝난 마지막 레코드가 중간으로 정렬되어도 다음 레코드와 붙지 않도록 한다.
+        if (recs[i].rec_len == 0 || recs[i].rec[recs[i].rec_len - 1] != '\n') {
+            putchar('\n');
+        }
+    }
+
+    free(recs);
+    if (mapped) munmap(buf, len);
+    else free(buf);
+}
+
+
 /**
  * @brief qsort에 사용될 비교 함수. 두 라인을 g_opts에 따라 비교합니다.
  *        이 함수는 `-u` 옵션의 중복 검사에도 재사용됩니다.
@@ -109,20 +425,45 @@ int main(int argc, char *argv[]) {
     // 구조체를 0으로 초기화하고 기본 구분자 설정
     memset(&g_opts, 0, sizeof(g_opts));
     g_opts.delimiter = ' '; 
+    int delimiter_set = 0; // --csv에서 -t가 없으면 기본 구분자를 ','로 바꾸기 위함
+
+    static const struct option long_opts[] = {
+        {"csv", no_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}
+    };
 
     int opt;
-    while ((opt = getopt(argc, argv, "rnuk:t:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "rnuk:t:", long_opts, NULL)) != -1) {
         switch (opt) {
             case 'r': g_opts.reverse = 1; break;
             case 'n': g_opts.numeric = 1; break;
             case 'u': g_opts.unique = 1; break;
             case 'k': g_opts.sort_key = atoi(optarg); break;
-            case 't': g_opts.delimiter = optarg[0]; break;
+            case 't': g_opts.delimiter = optarg[0]; delimiter_set = 1; break;
+            case 'C': g_opts.csv = 1; break;
             default:
-                fprintf(stderr, "Usage: %s [-rnu] [-k field] [-t delim] [file]\n", argv[0]);
+                fprintf(stderr, "Usage: %s [-rnu] [-k field] [-t delim] [--csv] [file]\n", argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
+    if (g_opts.csv && !delimiter_set) {
+        g_opts.delimiter = ',';
+    }
+
+    // --csv: 줄 단위(fgets) 대신 레코드 단위로 처리하는 별도 경로
+    if (g_opts.csv) {
+        int fd = STDIN_FILENO;
+        if (optind < argc) {
+            fd = open(argv[optind], O_RDONLY);
+            if (fd < 0) {
+                perror("Error opening file");
+                exit(EXIT_FAILURE);
+            }
+        }
+        sort_csv(fd);
+        if (fd != STDIN_FILENO) close(fd);
+        return 0;
+    }
 
     // 2. 파일 처리
     FILE *fp = stdin;
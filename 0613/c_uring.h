@@ -0,0 +1,146 @@
+#ifndef C_URING_H
+#define C_URING_H
+
+// io_uring을 liburing 없이 시스템 호출로 직접 다루는 최소한의 래퍼.
+// c_ls(STATX 일괄 처리), c_rm(UNLINKAT 일괄 처리)이 #include 하여 함께 쓰며,
+// 도구마다 쓰는 함수가 달라도 경고가 나지 않도록 모두 static inline으로 둔다.
+//
+// 커널이 io_uring을 지원하지 않거나 seccomp 등으로 막혀 있으면 uring_init()이
+// -1을 돌려주므로, 호출자는 그때 동기 시스템 호출 루프로 대신 처리하면 된다.
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>       // mmap (SQ/CQ 링 공유 메모리)
+#include <sys/syscall.h>    // __NR_io_uring_setup, __NR_io_uring_enter
+#include <linux/io_uring.h> // struct io_uring_sqe, io_uring_cqe, IORING_OP_*
+
+// 제출(SQ)/완료(CQ) 링. 커널과 공유하는 메모리를 가리키는 포인터들을 모아 둔다.
+typedef struct {
+    int fd;                     // io_uring 인스턴스 fd
+    unsigned sq_entries;        // 한 번에 제출할 수 있는 최대 요청 수
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;    // munmap을 위해 기억해 둔다
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned sq_local_tail;     // 아직 커널에 알리지 않은 제출 위치
+    unsigned to_submit;         // 다음 uring_submit()에서 제출할 요청 수
+} Uring;
+
+/**
+ * @brief io_uring 인스턴스를 만들고 링을 매핑합니다.
+ * @param ring 초기화할 Uring 구조체
+ * @param entries 링 크기 (2의 거듭제곱으로 올림됨)
+ * @return 성공 시 0, 사용할 수 없으면 -1 (errno 설정)
+ */
+static inline int uring_init(Uring *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return -1;
+    ring->fd = fd;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    // 커널이 지원하면 SQ와 CQ 링을 한 번의 mmap으로 매핑한다.
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) goto fail;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) goto fail_sq;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto fail_cq;
+
+    char *sq = ring->sq_ring, *cq = ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_local_tail = *ring->sq_tail;
+    return 0;
+
+fail_cq:
+    if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+fail_sq:
+    munmap(ring->sq_ring, ring->sq_ring_size);
+fail:
+    close(fd);
+    return -1;
+}
+
+// 링을 해제한다.
+static inline void uring_exit(Uring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+/**
+ * @brief 비어 있는 제출 슬롯(SQE)을 하나 얻습니다. 내용은 0으로 초기화되어 있습니다.
+ * @return SQE 포인터, 링이 가득 찼으면 NULL
+ */
+static inline struct io_uring_sqe *uring_get_sqe(Uring *ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) return NULL;
+
+    unsigned index = ring->sq_local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    ring->sq_local_tail++;
+    ring->to_submit++;
+    return sqe;
+}
+
+/**
+ * @brief 쌓아 둔 요청을 제출하고, 최소 wait_nr개가 완료될 때까지 기다립니다.
+ * @return 성공 시 0, 실패 시 -1 (errno 설정)
+ */
+static inline int uring_submit(Uring *ring, unsigned wait_nr) {
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+    int ret = (int)syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait_nr, flags, NULL, 0);
+    if (ret < 0) return -1;
+    ring->to_submit -= (unsigned)ret < ring->to_submit ? (unsigned)ret : ring->to_submit;
+    return 0;
+}
+
+/**
+ * @brief 완료된 요청 하나를 꺼냅니다. 다 쓴 뒤에는 uring_cqe_seen()을 호출해야 합니다.
+ * @return 완료 항목 포인터, 없으면 NULL
+ */
+static inline struct io_uring_cqe *uring_peek_cqe(Uring *ring) {
+    unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) return NULL;
+    return &ring->cqes[head & *ring->cq_mask];
+}
+
+static inline void uring_cqe_seen(Uring *ring) {
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+#endif // C_URING_H
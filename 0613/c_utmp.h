@@ -0,0 +1,89 @@
+#ifndef C_UTMP_H
+#define C_UTMP_H
+
+// utmp/wtmp 파일을 읽는 도구들(c_who, c_w)이 함께 쓰는 부품.
+//
+// utmp와 wtmp는 고정 크기 struct utmp 레코드를 이어 붙인 파일이다.
+// getutent()처럼 레코드마다 libc를 부르는 대신, 파일 전체를 mmap하여 레코드 배열로 본다.
+// 필요한 페이지만 읽히므로 수 GB의 wtmp에서도 찾는 구간만 디스크에서 올라온다.
+// c_walk.h처럼 모두 static inline 함수로 두어, 일부만 써도 경고가 나지 않는다.
+
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <utmp.h>       // struct utmp, _PATH_UTMP, _PATH_WTMP
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>   // mmap (utmp/wtmp 파일을 레코드 배열로)
+#include <sys/stat.h>
+
+typedef struct {
+    const struct utmp *records; // 레코드 배열 (파일이 비었으면 NULL)
+    size_t count;
+    size_t map_size;
+} UtmpFile;
+
+/**
+ * @brief 열린 utmp 형식 파일을 지금 크기만큼 읽기 전용으로 mmap합니다.
+ * @return 성공 시 0, 실패 시 -1 (errno 설정)
+ *
+ * 끝에 쓰다 만 레코드 조각이 있으면 무시합니다. 다른 프로세스가 레코드를 고쳐 쓰면
+ * 매핑에도 바로 보이므로, c_who --watch는 크기가 바뀔 때만 다시 매핑합니다.
+ */
+static inline int utmp_map_fd(int fd, UtmpFile *f) {
+    memset(f, 0, sizeof(*f));
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    f->count = (size_t)st.st_size / sizeof(struct utmp);
+    if (f->count > 0) {
+        f->map_size = f->count * sizeof(struct utmp);
+        void *map = mmap(NULL, f->map_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            f->count = f->map_size = 0;
+            return -1;
+        }
+        f->records = map;
+    }
+    return 0;
+}
+
+/**
+ * @brief utmp 형식 파일을 읽기 전용으로 mmap합니다.
+ * @param path 파일 경로 (_PATH_UTMP, _PATH_WTMP 등)
+ * @param f 결과를 채울 구조체
+ * @return 성공 시 0, 실패 시 -1 (errno 설정)
+ */
+static inline int utmp_open(const char *path, UtmpFile *f) {
+    memset(f, 0, sizeof(*f));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return -1;
+    int ret = utmp_map_fd(fd, f);
+    int err = errno;
+    close(fd); // 매핑은 fd를 닫아도 유지된다.
+    errno = err;
+    return ret;
+}
+
+static inline void utmp_close(UtmpFile *f) {
+    if (f->records) munmap((void *)f->records, f->map_size);
+    memset(f, 0, sizeof(*f));
+}
+
+/**
+ * @brief 시각 t 이후(t 포함)에 기록된 첫 레코드의 위치를 이진 탐색으로 찾습니다.
+ * @return 레코드 인덱스, 모두 t 이전이면 f->count
+ *
+ * wtmp는 덧붙이기만 하므로 시각 순으로 정렬되어 있다고 봅니다.
+ * (시계를 되돌린 구간이 있으면 그 근처의 경계는 조금 어긋날 수 있음)
+ */
+static inline size_t utmp_lower_bound(const UtmpFile *f, time_t t) {
+    size_t lo = 0, hi = f->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((time_t)f->records[mid].ut_tv.tv_sec < t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+#endif // C_UTMP_H
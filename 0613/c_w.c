@@ -0,0 +1,320 @@
+#define _GNU_SOURCE     // for memrchr (c_proc.h)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>     // sysconf
+#include <getopt.h>     // getopt_long (--file)
+#include <fcntl.h>      // open
+#include <time.h>       // time, localtime, strftime
+#include <sys/stat.h>   // stat (터미널의 장치 번호와 마지막 입력 시각)
+#include "c_proc.h"     // /proc 읽기, tty 이름 (c_ps, c_pgrep와 공유)
+#include "c_utmp.h"     // mmap으로 utmp 읽기 (c_who와 공유)
+
+// w: 로그인한 세션마다 무엇을 하고 있는지 보여준다.
+// utmp의 세션 목록과 /proc의 프로세스 목록을 제어 터미널(tty_nr)로 이어 붙인다.
+
+// 명령줄 옵션을 담는 구조체
+typedef struct {
+    int no_header;      // -h: 첫 줄(시각, 가동 시간, 부하)과 열 제목을 찍지 않음
+    int short_format;   // -s: LOGIN@, JCPU, PCPU 열을 뺌
+    const char *file;   // --file: 읽을 utmp 형식 파일 (기본 _PATH_UTMP)
+    const char *user;   // 인자로 준 사용자의 세션만
+} WOptions;
+
+// --- 터미널별 프로세스 모음 ---
+// /proc을 한 번만 훑으며 제어 터미널이 있는 프로세스를 tty_nr별 버킷에 모은다.
+// 세션마다 /proc 전체를 다시 훑으면 (세션 수 × 프로세스 수)만큼 걸리므로
+// 세션이 수백 개인 서버에서는 세션이 늘수록 제곱으로 느려진다.
+
+typedef struct {
+    int tty_nr;                 // 0이면 빈 슬롯 (제어 터미널이 없는 프로세스는 넣지 않는다)
+    unsigned long long cpu;     // 이 터미널의 모든 프로세스의 utime + stime 합 (clock tick)
+    int fg_pid;                 // 포그라운드 프로세스 그룹에서 가장 늦게 시작한 프로세스
+    unsigned long long fg_start;
+    unsigned long long fg_cpu;
+    char fg_comm[64];           // cmdline이 비어 있을 때 대신 보여줄 이름
+} TtyBucket;
+
+// tty_nr -> 버킷. 개방 주소법 해시 테이블
+typedef struct {
+    TtyBucket *slots;
+    size_t cap, count;          // cap은 2의 거듭제곱
+} TtyTable;
+
+static size_t tty_hash(int tty_nr, size_t cap) {
+    return (size_t)((uint32_t)tty_nr * 0x9E3779B1u) & (cap - 1);
+}
+
+/**
+ * @brief tty_nr의 버킷을 찾습니다.
+ * @param create 없으면 새로 만들지
+ * @return 버킷, create가 0이고 없으면 NULL
+ */
+static TtyBucket *tty_table_get(TtyTable *t, int tty_nr, int create) {
+    if (create && (t->count + 1) * 2 > t->cap) {
+        // 절반 이상 차면 두 배로 늘리고 다시 넣는다.
+        size_t new_cap = t->cap ? t->cap * 2 : 64;
+        TtyBucket *slots = calloc(new_cap, sizeof(TtyBucket));
+        if (!slots) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < t->cap; i++) {
+            if (!t->slots[i].tty_nr) continue;
+            size_t j = tty_hash(t->slots[i].tty_nr, new_cap);
+            while (slots[j].tty_nr) j = (j + 1) & (new_cap - 1);
+            slots[j] = t->slots[i];
+        }
+        free(t->slots);
+        t->slots = slots;
+        t->cap = new_cap;
+    }
+    if (t->cap == 0) return NULL;
+
+    size_t i = tty_hash(tty_nr, t->cap);
+    while (t->slots[i].tty_nr) {
+        if (t->slots[i].tty_nr == tty_nr) return &t->slots[i];
+        i = (i + 1) & (t->cap - 1);
+    }
+    if (!create) return NULL;
+    t->slots[i].tty_nr = tty_nr;
+    t->count++;
+    return &t->slots[i];
+}
+
+/**
+ * @brief /proc을 한 번 훑어 터미널마다 CPU 합계와 포그라운드 프로세스를 모읍니다.
+ *
+ * 프로세스마다 stat 하나만 읽습니다. 포그라운드 여부는 stat의 pgrp와 tpgid(터미널의
+ * 포그라운드 프로세스 그룹)가 같은지로 정하고, 그중 가장 늦게 시작한 것을 고릅니다.
+ * (셸에서 실행한 명령이 셸보다 늦게 시작하므로)
+ */
+static void scan_processes(int proc_fd, TtyTable *ttys) {
+    char *dirent_buf = malloc(DIRENT_BUF_SIZE);
+    if (!dirent_buf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    size_t npids;
+    int *pids = proc_list_pids(proc_fd, dirent_buf, &npids);
+    free(dirent_buf);
+
+    ProcBuf buf = {0};
+    char path[64];
+    for (size_t i = 0; i < npids; i++) {
+        snprintf(path, sizeof(path), "%d/stat", pids[i]);
+        ProcStat st;
+        // 그 사이 끝난 프로세스는 건너뛴다.
+        if (proc_read_file(proc_fd, path, &buf) != 0 || parse_proc_stat(buf.data, buf.len, &st) != 0) {
+            continue;
+        }
+        if (st.tty_nr == 0) continue;
+
+        TtyBucket *b = tty_table_get(ttys, st.tty_nr, 1);
+        unsigned long long cpu = st.utime + st.stime;
+        b->cpu += cpu;
+        if (st.pgrp == st.tpgid && (b->fg_pid == 0 || st.starttime >= b->fg_start)) {
+            b->fg_pid = st.pid;
+            b->fg_start = st.starttime;
+            b->fg_cpu = cpu;
+            memcpy(b->fg_comm, st.comm, sizeof(b->fg_comm));
+        }
+    }
+    free(buf.data);
+    free(pids);
+}
+
+// --- 출력 ---
+
+/**
+ * @brief 시간 간격을 w 형식의 7칸 글자로 만듭니다.
+ * @param centis 1/100초 단위 간격
+ *
+ * 1분 미만 "12.34s", 1시간 미만 "분:초", 2일 미만 "시:분m", 그 이상 "N일days"
+ */
+static void format_interval(unsigned long long centis, char *out, size_t size) {
+    unsigned long long secs = centis / 100;
+    if (secs >= 2 * 86400) {
+        snprintf(out, size, "%3lludays", secs / 86400);
+    } else if (secs >= 3600) {
+        snprintf(out, size, "%2llu:%02llum", secs / 3600, secs / 60 % 60);
+    } else if (secs >= 60) {
+        snprintf(out, size, "%2llu:%02llu ", secs / 60, secs % 60);
+    } else {
+        snprintf(out, size, "%2llu.%02llus", secs, centis % 100);
+    }
+}
+
+/**
+ * @brief 로그인 시각을 w처럼 가까우면 자세히, 멀면 짧게 만듭니다.
+ *
+ * 12시간 이내 "시:분", 일주일 이내 "요일시", 그 이상 "일월년"
+ */
+static void format_login(time_t login, time_t now, char *out, size_t size) {
+    struct tm *tm = localtime(&login);
+    if (now - login < 12 * 3600) {
+        strftime(out, size, "%H:%M", tm);
+    } else if (now - login < 7 * 86400) {
+        strftime(out, size, "%a%H", tm);
+    } else {
+        strftime(out, size, "%d%b%y", tm);
+    }
+}
+
+/**
+ * @brief 첫 줄: 현재 시각, 가동 시간, 사용자 수, 부하 평균 (uptime과 같은 형식)
+ */
+static void print_summary(int proc_fd, int users, time_t now) {
+    ProcBuf buf = {0};
+    double uptime = 0, load[3] = {0, 0, 0};
+    if (proc_read_file(proc_fd, "uptime", &buf) == 0) {
+        sscanf(buf.data, "%lf", &uptime);
+    }
+    if (proc_read_file(proc_fd, "loadavg", &buf) == 0) {
+        sscanf(buf.data, "%lf %lf %lf", &load[0], &load[1], &load[2]);
+    }
+    free(buf.data);
+
+    char now_buf[16];
+    strftime(now_buf, sizeof(now_buf), "%H:%M:%S", localtime(&now));
+    long up_min = (long)uptime / 60;
+    printf(" %s up ", now_buf);
+    if (up_min >= 1440) {
+        printf("%ld day%s, ", up_min / 1440, up_min / 1440 == 1 ? "" : "s");
+    }
+    if (up_min % 1440 >= 60) {
+        printf("%2ld:%02ld, ", up_min % 1440 / 60, up_min % 60);
+    } else {
+        printf("%ld min, ", up_min % 60);
+    }
+    printf(" %d user%s,  load average: %.2f, %.2f, %.2f\n",
+           users, users == 1 ? "" : "s", load[0], load[1], load[2]);
+}
+
+/**
+ * @brief 세션 하나를 출력합니다.
+ * @param ttys scan_processes가 채운 터미널별 버킷
+ * @param clk_tck 초당 clock tick 수
+ *
+ * 터미널 장치를 stat 한 번 하여 장치 번호(버킷 키)와 마지막 입력 시각(atime, 유휴 시간)을 함께 얻습니다.
+ */
+static void print_session(int proc_fd, const struct utmp *u, TtyTable *ttys, const WOptions *opts,
+                          long clk_tck, time_t now, ProcBuf *cmdline) {
+    char tty_path[64], idle[24], jcpu[24], pcpu[24], login[24];
+    snprintf(tty_path, sizeof(tty_path), "/dev/%.*s", UT_LINESIZE, u->ut_line);
+
+    TtyBucket *b = NULL;
+    struct stat st;
+    if (stat(tty_path, &st) == 0 && S_ISCHR(st.st_mode)) {
+        long long idle_secs = (long long)(now - st.st_atime);
+        format_interval(idle_secs > 0 ? (unsigned long long)idle_secs * 100 : 0, idle, sizeof(idle));
+        b = tty_table_get(ttys, proc_tty_nr(st.st_rdev), 0);
+    } else {
+        snprintf(idle, sizeof(idle), "?");
+    }
+
+    // 포그라운드 프로세스의 명령줄. 비어 있으면(커널 스레드 등) 실행 파일 이름으로 대신한다.
+    const char *what = "-";
+    if (b && b->fg_pid) {
+        char path[64];
+        snprintf(path, sizeof(path), "%d/cmdline", b->fg_pid);
+        if (proc_read_file(proc_fd, path, cmdline) == 0 && proc_cmdline_text(cmdline) > 0) {
+            what = cmdline->data;
+        } else {
+            what = b->fg_comm;
+        }
+    }
+
+    printf("%-8.*s %-8.*s %-16.*s ", UT_NAMESIZE, u->ut_user, UT_LINESIZE, u->ut_line,
+           UT_HOSTSIZE < 16 ? UT_HOSTSIZE : 16, u->ut_host[0] ? u->ut_host : "-");
+    if (!opts->short_format) {
+        format_login(u->ut_tv.tv_sec, now, login, sizeof(login));
+        printf("%-7s ", login);
+    }
+    printf("%7s ", idle);
+    if (!opts->short_format) {
+        if (b) {
+            format_interval(b->cpu * 100 / clk_tck, jcpu, sizeof(jcpu));
+            format_interval(b->fg_pid ? b->fg_cpu * 100 / clk_tck : 0, pcpu, sizeof(pcpu));
+        } else {
+            snprintf(jcpu, sizeof(jcpu), "-");
+            snprintf(pcpu, sizeof(pcpu), "-");
+        }
+        printf("%7s %7s ", jcpu, pcpu);
+    }
+    printf("%s\n", what);
+}
+
+int main(int argc, char *argv[]) {
+    WOptions opts = {0};
+
+    static const struct option long_opts[] = {
+        {"file", required_argument, NULL, 'F'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hs", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'h': opts.no_header = 1;    break;
+            case 's': opts.short_format = 1; break;
+            case 'F': opts.file = optarg;    break;
+            default:
+                fprintf(stderr, "사용법: %s [-hs] [--file FILE] [user]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind < argc) opts.user = argv[optind];
+
+    const char *path = opts.file ? opts.file : _PATH_UTMP;
+    UtmpFile utmp;
+    if (utmp_open(path, &utmp) != 0) {
+        // 기본 utmp가 없으면(컨테이너 등) 로그인한 사람이 없는 것으로 본다.
+        if (opts.file || errno != ENOENT) {
+            fprintf(stderr, "w: %s: %s\n", path, strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int proc_fd = open(PROC_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (proc_fd == -1) {
+        perror("open " PROC_DIR);
+        exit(EXIT_FAILURE);
+    }
+    long clk_tck = sysconf(_SC_CLK_TCK);
+    if (clk_tck <= 0) clk_tck = 100;
+    time_t now = time(NULL);
+
+    int users = 0;
+    for (size_t i = 0; i < utmp.count; i++) {
+        if (utmp.records[i].ut_type == USER_PROCESS && utmp.records[i].ut_user[0]) users++;
+    }
+    if (!opts.no_header) {
+        print_summary(proc_fd, users, now);
+        if (opts.short_format) {
+            printf("%-8s %-8s %-16s %7s %s\n", "USER", "TTY", "FROM", "IDLE", "WHAT");
+        } else {
+            printf("%-8s %-8s %-16s %-7s %7s %7s %7s %s\n",
+                   "USER", "TTY", "FROM", "LOGIN@", "IDLE", "JCPU", "PCPU", "WHAT");
+        }
+    }
+
+    // 세션이 있을 때만 /proc을 (한 번) 훑는다.
+    TtyTable ttys = {0};
+    if (users > 0) scan_processes(proc_fd, &ttys);
+
+    ProcBuf cmdline = {0};
+    for (size_t i = 0; i < utmp.count; i++) {
+        const struct utmp *u = &utmp.records[i];
+        if (u->ut_type != USER_PROCESS || u->ut_user[0] == '\0') continue;
+        if (opts.user && strncmp(u->ut_user, opts.user, UT_NAMESIZE) != 0) continue;
+        print_session(proc_fd, u, &ttys, &opts, clk_tck, now, &cmdline);
+    }
+
+    free(cmdline.data);
+    free(ttys.slots);
+    close(proc_fd);
+    utmp_close(&utmp);
+    return EXIT_SUCCESS;
+}
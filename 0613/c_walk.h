@@ -0,0 +1,133 @@
+#ifndef C_WALK_H
+#define C_WALK_H
+
+// 디렉터리 탐색 도구들(c_ls, c_du 등)이 함께 쓰는 부품 모음.
+//  - getdents64로 디렉터리 항목을 큰 버퍼 단위로 읽기
+//  - 필요할 때마다 2배씩 늘어나는 배열
+//  - 자식 디렉터리들이 openat 기준으로 공유하는 부모 fd (참조 카운트)
+//  - 작업 훔치기(work-stealing)용 덱
+// 각 도구가 #include 하는 것만으로 쓸 수 있도록 모두 static inline 함수로 둔다.
+// (쓰지 않는 함수가 있어도 경고가 나지 않는다)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>    // SYS_getdents64
+
+// getdents64 한 번에 읽어올 버퍼 크기. 클수록 큰 디렉터리에서 시스템 호출 횟수가 줄어든다.
+#define DIRENT_BUF_SIZE (256 * 1024)
+
+// 커널이 getdents64로 돌려주는 레코드 형식 (glibc의 struct dirent와 달리 가변 길이)
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/**
+ * @brief 디렉터리 항목을 buf(DIRENT_BUF_SIZE 바이트)에 최대한 많이 읽어옵니다.
+ * @return 읽은 바이트 수, 디렉터리 끝이면 0, 실패 시 -1
+ *
+ * 사용 예:
+ *   while ((n = read_dirents(fd, buf)) > 0)
+ *       for (long off = 0; off < n; off += e->d_reclen) { e = (struct linux_dirent64 *)(buf + off); ... }
+ */
+static inline long read_dirents(int dirfd, char *buf) {
+    return syscall(SYS_getdents64, dirfd, buf, DIRENT_BUF_SIZE);
+}
+
+// "."과 ".."인지 확인한다.
+static inline int is_dot_or_dotdot(const char *name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// 배열이 꽉 찼을 때 크기를 늘린다. 실패하면 더 진행할 수 없으므로 종료한다.
+static inline void *grow_array(void *ptr, size_t *cap, size_t need, size_t elem_size) {
+    if (need <= *cap) return ptr;
+    size_t new_cap = *cap ? *cap : 64;
+    while (new_cap < need) new_cap *= 2;
+    void *p = realloc(ptr, new_cap * elem_size);
+    if (!p) {
+        perror("realloc");
+        exit(EXIT_FAILURE);
+    }
+    *cap = new_cap;
+    return p;
+}
+
+// 자식 작업들이 openat의 기준으로 함께 쓰는 부모 디렉터리 fd
+// 마지막 자식이 자신의 디렉터리를 연 뒤에 닫힌다.
+typedef struct {
+    int fd;
+    atomic_int refs;
+} SharedFd;
+
+// 자식 users개가 함께 쓸 fd를 만든다. fd의 소유권은 SharedFd로 넘어간다.
+static inline SharedFd *shared_fd_new(int fd, int users) {
+    SharedFd *sfd = malloc(sizeof(SharedFd));
+    if (!sfd) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    sfd->fd = fd;
+    atomic_init(&sfd->refs, users);
+    return sfd;
+}
+
+static inline void shared_fd_unref(SharedFd *sfd) {
+    if (atomic_fetch_sub(&sfd->refs, 1) == 1) {
+        close(sfd->fd);
+        free(sfd);
+    }
+}
+
+// 작업 스레드 하나가 소유하는 덱. 주인은 뒤에서 꺼내고(LIFO), 다른 스레드는 앞에서 훔친다.
+// 배열은 필요할 때 늘어나므로 상한이 없다.
+typedef struct {
+    pthread_mutex_t lock;
+    void **items;
+    size_t head, tail, cap;
+} WorkDeque;
+
+static inline void deque_init(WorkDeque *dq) {
+    memset(dq, 0, sizeof(*dq));
+    pthread_mutex_init(&dq->lock, NULL);
+}
+
+static inline void deque_destroy(WorkDeque *dq) {
+    free(dq->items);
+    pthread_mutex_destroy(&dq->lock);
+}
+
+static inline void deque_push(WorkDeque *dq, void *item) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail == dq->cap) {
+        // 앞쪽 빈 공간을 당겨 쓰고, 그래도 부족하면 늘린다.
+        size_t n = dq->tail - dq->head;
+        memmove(dq->items, dq->items + dq->head, n * sizeof(void *));
+        dq->head = 0;
+        dq->tail = n;
+        dq->items = grow_array(dq->items, &dq->cap, n + 1, sizeof(void *));
+    }
+    dq->items[dq->tail++] = item;
+    pthread_mutex_unlock(&dq->lock);
+}
+
+// steal이 0이면 주인으로서 뒤에서, 1이면 다른 스레드로서 앞에서 꺼낸다. 비었으면 NULL.
+static inline void *deque_pop(WorkDeque *dq, int steal) {
+    void *item = NULL;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->head < dq->tail) {
+        item = steal ? dq->items[dq->head++] : dq->items[--dq->tail];
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return item;
+}
+
+#endif // C_WALK_H
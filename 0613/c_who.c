@@ -1,61 +1,505 @@
+#define _GNU_SOURCE     // for strptime
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <utmp.h>       // utmp 구조체 및 관련 함수
+#include <stdint.h>
+#include <errno.h>
+#include <utmp.h>       // utmp 구조체, _PATH_UTMP, _PATH_WTMP
 #include <unistd.h>     // getopt, ttyname
-#include <time.h>       // ctime, strftime
+#include <getopt.h>     // getopt_long (--file, --since, --until, --user, --watch)
+#include <libgen.h>     // dirname, basename (--watch에서 utmp가 바뀌어 놓이는 것 감시)
+#include <fcntl.h>      // open
+#include <time.h>       // ctime, strftime, strptime, mktime
 #include <sys/stat.h>   // stat (터미널 상태 확인용)
+#include <sys/inotify.h> // --watch: utmp 변경 알림
+#include "c_walk.h"     // grow_array
+#include "c_utmp.h"     // mmap으로 utmp/wtmp 읽기 (c_w와 공유)
+
+// --- last 형식 조회 (--since, --until, --user) ---
+// 구간 안의 로그인(USER_PROCESS)을 세션으로 만들고, 같은 터미널(ut_line)의 로그아웃(DEAD_PROCESS)이나
+// 재부팅/종료 기록으로 닫는다. 열린 세션은 터미널 이름을 키로 하는 해시 테이블에서 찾는다.
+
+// 세션이 끝난 방식
+enum { SESSION_OPEN, SESSION_LOGOUT, SESSION_CRASH, SESSION_DOWN, SESSION_GONE };
+
+typedef struct {
+    const struct utmp *login;
+    time_t logout;
+    int end;                    // SESSION_*
+} Session;
+
+#define NO_SESSION SIZE_MAX
+
+// 터미널 이름 -> 그 터미널에 열려 있는 세션. 터미널 수는 적으므로 슬롯은 지우지 않고 비워 둔다.
+typedef struct {
+    char line[UT_LINESIZE];
+    size_t session;             // NO_SESSION이면 열린 세션 없음
+    int used;
+} LineSlot;
+
+typedef struct {
+    LineSlot *slots;
+    size_t cap, count;          // cap은 2의 거듭제곱
+} LineTable;
+
+static size_t line_hash(const char *line) {
+    // FNV-1a. ut_line은 '\0'으로 끝나지 않을 수 있으므로 UT_LINESIZE까지만 본다.
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < UT_LINESIZE && line[i]; i++) {
+        h = (h ^ (unsigned char)line[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 터미널 이름의 슬롯을 찾고, 없으면 새로 만듭니다.
+ */
+static LineSlot *line_table_get(LineTable *t, const char *line) {
+    // 절반 이상 차면 두 배로 늘리고 다시 넣는다.
+    if ((t->count + 1) * 2 > t->cap) {
+        size_t new_cap = t->cap ? t->cap * 2 : 64;
+        LineSlot *slots = calloc(new_cap, sizeof(LineSlot));
+        if (!slots) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < t->cap; i++) {
+            if (!t->slots[i].used) continue;
+            size_t j = line_hash(t->slots[i].line) & (new_cap - 1);
+            while (slots[j].used) j = (j + 1) & (new_cap - 1);
+            slots[j] = t->slots[i];
+        }
+        free(t->slots);
+        t->slots = slots;
+        t->cap = new_cap;
+    }
+
+    size_t i = line_hash(line) & (t->cap - 1);
+    while (t->slots[i].used) {
+        if (strncmp(t->slots[i].line, line, UT_LINESIZE) == 0) return &t->slots[i];
+        i = (i + 1) & (t->cap - 1);
+    }
+    LineSlot *slot = &t->slots[i];
+    memcpy(slot->line, line, UT_LINESIZE); // ut_line은 항상 UT_LINESIZE 바이트 배열이다.
+    slot->session = NO_SESSION;
+    slot->used = 1;
+    t->count++;
+    return slot;
+}
+
+typedef struct {
+    time_t since, until;        // until이 없으면 한없이 먼 미래
+    const char *user;           // NULL이면 모든 사용자
+} QueryOptions;
+
+// 열린 세션을 모두 닫는다. (재부팅, 시스템 종료 기록)
+static size_t close_all_sessions(LineTable *lines, Session *sessions, time_t when, int end) {
+    size_t closed = 0;
+    for (size_t i = 0; i < lines->cap; i++) {
+        LineSlot *slot = &lines->slots[i];
+        if (!slot->used || slot->session == NO_SESSION) continue;
+        sessions[slot->session].logout = when;
+        sessions[slot->session].end = end;
+        slot->session = NO_SESSION;
+        closed++;
+    }
+    return closed;
+}
+
+/**
+ * @brief last 형식으로 세션 하나를 출력합니다.
+ */
+static void print_session(const Session *s) {
+    const struct utmp *u = s->login;
+    time_t login = u->ut_tv.tv_sec;
+    char login_buf[32], logout_buf[32];
+    strftime(login_buf, sizeof(login_buf), "%Y-%m-%d %H:%M", localtime(&login));
+
+    printf("%-8.*s %-12.*s %-16.*s %s", UT_NAMESIZE, u->ut_user, UT_LINESIZE, u->ut_line,
+           16, u->ut_host, login_buf);
+    if (s->end == SESSION_OPEN) {
+        printf("   still logged in\n");
+        return;
+    }
+
+    static const char *const end_names[] = { "", "", "crash", "down", "gone" };
+    if (s->end == SESSION_LOGOUT) {
+        strftime(logout_buf, sizeof(logout_buf), "%H:%M", localtime(&s->logout));
+    } else {
+        snprintf(logout_buf, sizeof(logout_buf), "%s", end_names[s->end]);
+    }
+    long minutes = (long)(s->logout - login) / 60;
+    if (minutes < 0) minutes = 0;
+    if (minutes >= 24 * 60) {
+        printf(" - %-5s (%ld+%02ld:%02ld)\n", logout_buf, minutes / (24 * 60),
+               minutes / 60 % 24, minutes % 60);
+    } else {
+        printf(" - %-5s (%02ld:%02ld)\n", logout_buf, minutes / 60, minutes % 60);
+    }
+}
+
+/**
+ * @brief wtmp에서 [since, until] 구간에 시작한 세션을 last처럼 최근 것부터 출력합니다.
+ * @return 성공 시 0, 파일을 열 수 없으면 -1
+ *
+ * 구간의 시작은 이진 탐색으로 찾고 구간 안의 레코드만 훑습니다. 구간이 끝난 뒤에는
+ * 아직 열린 세션을 닫는 기록(로그아웃, 재부팅, 종료)만 찾으며, 열린 세션이 없어지면 멈춥니다.
+ * 구간 전에 시작해 구간까지 이어진 세션은 보여주지 않습니다.
+ */
+int query_sessions(const char *path, const QueryOptions *q) {
+    UtmpFile f;
+    if (utmp_open(path, &f) != 0) {
+        fprintf(stderr, "who: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    Session *sessions = NULL;
+    size_t nsessions = 0, sessions_cap = 0, nopen = 0; // nopen: 아직 열린 세션 수
+    LineTable lines = {0};
+
+    for (size_t i = utmp_lower_bound(&f, q->since); i < f.count; i++) {
+        const struct utmp *u = &f.records[i];
+        int in_window = (time_t)u->ut_tv.tv_sec <= q->until;
+        if (!in_window && nopen == 0) break; // 구간이 끝났고 닫을 세션도 없다.
+
+        switch (u->ut_type) {
+            case USER_PROCESS: {
+                LineSlot *slot = line_table_get(&lines, u->ut_line);
+                // 로그아웃 기록 없이 같은 터미널에 새 로그인이 오면 이전 세션은 사라진 것으로 본다.
+                if (slot->session != NO_SESSION) {
+                    sessions[slot->session].logout = u->ut_tv.tv_sec;
+                    sessions[slot->session].end = SESSION_GONE;
+                    slot->session = NO_SESSION;
+                    nopen--;
+                }
+                if (!in_window) break;
+                if (q->user && strncmp(u->ut_user, q->user, UT_NAMESIZE) != 0) break;
+                sessions = grow_array(sessions, &sessions_cap, nsessions + 1, sizeof(Session));
+                sessions[nsessions].login = u;
+                sessions[nsessions].logout = 0;
+                sessions[nsessions].end = SESSION_OPEN;
+                slot->session = nsessions++;
+                nopen++;
+                break;
+            }
+            case DEAD_PROCESS: {
+                LineSlot *slot = line_table_get(&lines, u->ut_line);
+                if (slot->session != NO_SESSION) {
+                    sessions[slot->session].logout = u->ut_tv.tv_sec;
+                    sessions[slot->session].end = SESSION_LOGOUT;
+                    slot->session = NO_SESSION;
+                    nopen--;
+                }
+                break;
+            }
+            case BOOT_TIME:
+                // 종료 기록 없이 재부팅됐으면 열린 세션은 비정상 종료된 것이다.
+                nopen -= close_all_sessions(&lines, sessions, u->ut_tv.tv_sec, SESSION_CRASH);
+                break;
+            case RUN_LVL:
+                if (strncmp(u->ut_user, "shutdown", UT_NAMESIZE) == 0) {
+                    nopen -= close_all_sessions(&lines, sessions, u->ut_tv.tv_sec, SESSION_DOWN);
+                }
+                break;
+        }
+    }
+
+    // last처럼 최근 세션부터 출력한다.
+    for (size_t i = nsessions; i-- > 0; ) {
+        print_session(&sessions[i]);
+    }
+
+    free(sessions);
+    free(lines.slots);
+    utmp_close(&f);
+    return 0;
+}
+
+/**
+ * @brief "YYYY-MM-DD", "YYYY-MM-DD HH:MM[:SS]" 또는 "@초"(유닉스 시각)를 해석합니다.
+ * @return 성공 시 0, 형식이 틀리면 -1
+ */
+int parse_time_arg(const char *arg, time_t *out) {
+    if (arg[0] == '@') {
+        char *end;
+        long long secs = strtoll(arg + 1, &end, 10);
+        if (end == arg + 1 || *end != '\0') return -1;
+        *out = (time_t)secs;
+        return 0;
+    }
+    static const char *const formats[] = { "%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%d", NULL };
+    for (int i = 0; formats[i]; i++) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        const char *end = strptime(arg, formats[i], &tm);
+        if (end && *end == '\0') {
+            tm.tm_isdst = -1; // 서머타임 여부는 mktime이 정하게 한다.
+            *out = mktime(&tm);
+            return 0;
+        }
+    }
+    return -1;
+}
 
 // 함수 선언
-void print_entry(struct utmp *entry, int show_term_status);
-void print_quick_users(char *users[], int count);
+void print_entry(const struct utmp *entry, int show_term_status);
+
+// --- 세션 표 ---
+// utmp의 레코드 자리(slot)마다 마지막으로 본 레코드를 복사해 둔다. 자리 수만큼 늘어나므로 상한이 없다.
+// -q는 한 번 채워 로그인한 사용자만 세고, --watch는 파일이 바뀔 때 이 표와 비교해 달라진 자리만 알린다.
+
+typedef struct {
+    struct utmp *slots;
+    size_t count, cap;
+} SessionTable;
+
+// 로그인 세션을 나타내는 레코드인지
+static int is_session(const struct utmp *u) {
+    return u->ut_type == USER_PROCESS && u->ut_user[0] != '\0';
+}
+
+// 같은 세션인지: 사용자, 터미널, 프로세스, 로그인 시각이 모두 같아야 한다.
+static int same_session(const struct utmp *a, const struct utmp *b) {
+    return a->ut_pid == b->ut_pid && a->ut_tv.tv_sec == b->ut_tv.tv_sec &&
+           strncmp(a->ut_user, b->ut_user, UT_NAMESIZE) == 0 &&
+           strncmp(a->ut_line, b->ut_line, UT_LINESIZE) == 0;
+}
+
+/**
+ * @brief --watch 이벤트 한 줄을 출력합니다.
+ * @param what "LOGIN" 또는 "LOGOUT"
+ * @param when 이벤트 시각
+ */
+static void print_event(const char *what, const struct utmp *u, time_t when) {
+    char time_buf[30];
+    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", localtime(&when));
+    printf("%-6s %-8.*s %-12.*s %s", what, UT_NAMESIZE, u->ut_user, UT_LINESIZE, u->ut_line, time_buf);
+    if (u->ut_host[0] != '\0') {
+        printf(" (%.*s)", UT_HOSTSIZE, u->ut_host);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief slot번째 자리를 새 레코드로 바꿉니다.
+ * @param rec 새 레코드. NULL이면 그 자리가 없어진 것(파일이 줄어듦)
+ * @param report 세션이 끝나거나 시작되었으면 이벤트로 출력할지
+ * @return 자리 내용이 바뀌었으면 1
+ */
+static int session_table_set(SessionTable *t, size_t slot, const struct utmp *rec, int report) {
+    static const struct utmp empty; // 새로 생긴 자리는 빈 레코드였던 것으로 본다.
+    if (slot >= t->count) {
+        t->slots = grow_array(t->slots, &t->cap, slot + 1, sizeof(struct utmp));
+        for (size_t i = t->count; i <= slot; i++) t->slots[i] = empty;
+        t->count = slot + 1;
+    }
+    struct utmp *old = &t->slots[slot];
+    if (!rec) rec = &empty;
+    if (memcmp(old, rec, sizeof(struct utmp)) == 0) return 0;
+
+    if (report) {
+        int was = is_session(old), is = is_session(rec);
+        if (was && (!is || !same_session(old, rec))) {
+            // 로그아웃하면 그 자리가 같은 시각의 DEAD_PROCESS 레코드로 바뀐다. 그 밖의 경우는 지금 시각으로.
+            time_t when = rec->ut_type == DEAD_PROCESS ? (time_t)rec->ut_tv.tv_sec : time(NULL);
+            print_event("LOGOUT", old, when);
+        }
+        if (is && (!was || !same_session(old, rec))) {
+            print_event("LOGIN", rec, rec->ut_tv.tv_sec);
+        }
+    }
+    *old = *rec;
+    return 1;
+}
+
+// 매핑된 레코드 전체를 표와 맞춘다. 파일이 줄었으면 뒤쪽 자리는 비운다.
+static void session_table_sync(SessionTable *t, const UtmpFile *f, int report) {
+    for (size_t i = 0; i < f->count; i++) {
+        session_table_set(t, i, &f->records[i], report);
+    }
+    for (size_t i = f->count; i < t->count; i++) {
+        session_table_set(t, i, NULL, report);
+    }
+}
+
+void print_quick_users(const SessionTable *t);
+
+// --- --watch: inotify로 utmp 변경을 기다렸다가 바뀐 세션만 알리기 ---
+// utmp는 로그인/로그아웃 때 자기 자리의 레코드만 고쳐 쓴다. 매핑은 그대로 두고
+// IN_MODIFY가 올 때마다 표와 비교하므로 read()로 파일을 다시 읽지 않고, 주기적으로 깨어나지도 않는다.
+// 파일이 통째로 바뀌어 놓이면(rename) 부모 디렉터리 감시로 알아채고 새 파일을 다시 연다.
+
+/**
+ * @brief utmp를 열고 매핑해 watch 상태를 바꿉니다. 기존 것은 닫습니다.
+ * @return 성공 시 0, 실패 시 -1 (errno 설정)
+ */
+static int watch_reopen(const char *path, int inotify_fd, int *fd, int *wd, UtmpFile *f) {
+    if (*wd != -1) inotify_rm_watch(inotify_fd, *wd);
+    if (*fd != -1) close(*fd);
+    utmp_close(f);
+    *wd = -1;
+    *fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (*fd == -1) return -1;
+    *wd = inotify_add_watch(inotify_fd, path, IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+    if (*wd == -1) return -1;
+    return utmp_map_fd(*fd, f);
+}
+
+/**
+ * @brief 지금 로그인한 세션을 출력하고, 이후 로그인/로그아웃을 일어나는 대로 한 줄씩 출력합니다.
+ * @return 실패 시 EXIT_FAILURE (정상이라면 돌아오지 않음)
+ */
+int watch_sessions(const char *path, int show_term_status) {
+    int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd == -1) {
+        perror("inotify_init1");
+        return EXIT_FAILURE;
+    }
+    // 부모 디렉터리도 감시하여, 파일을 새로 만들어 바꿔 놓는 경우를 알아챈다.
+    char *dir_copy = strdup(path), *base_copy = strdup(path);
+    if (!dir_copy || !base_copy) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    const char *base = basename(base_copy);
+    int dir_wd = inotify_add_watch(inotify_fd, dirname(dir_copy), IN_CREATE | IN_MOVED_TO);
+
+    int fd = -1, wd = -1;
+    UtmpFile f;
+    memset(&f, 0, sizeof(f));
+    if (watch_reopen(path, inotify_fd, &fd, &wd, &f) != 0) {
+        fprintf(stderr, "who: %s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // 처음 상태는 평소의 who 형식으로 출력한다.
+    SessionTable table = {0};
+    session_table_sync(&table, &f, 0);
+    for (size_t i = 0; i < table.count; i++) {
+        if (is_session(&table.slots[i])) print_entry(&table.slots[i], show_term_status);
+    }
+    fflush(stdout);
+
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t n = read(inotify_fd, events, sizeof(events)); // 변경이 있을 때까지 잠든다.
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("read");
+            return EXIT_FAILURE;
+        }
+
+        int modified = 0, replaced = 0;
+        for (char *p = events; p < events + n; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(*ev) + ev->len;
+            if (ev->wd == dir_wd) {
+                if (ev->len > 0 && strcmp(ev->name, base) == 0) replaced = 1;
+            } else if (ev->wd == wd) {
+                if (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) replaced = 1;
+                else modified = 1;
+            }
+        }
+
+        if (replaced) {
+            // 새 파일이 아직 없으면(지운 뒤 다시 만드는 중) 모두 로그아웃한 것으로 보고 만들어지길 기다린다.
+            if (watch_reopen(path, inotify_fd, &fd, &wd, &f) != 0 && errno != ENOENT) {
+                fprintf(stderr, "who: %s: %s\n", path, strerror(errno));
+                return EXIT_FAILURE;
+            }
+        } else if (modified) {
+            // 크기가 바뀌었을 때만 다시 매핑한다. 자리를 고쳐 쓴 것은 매핑에 이미 보인다.
+            struct stat st;
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size / sizeof(struct utmp) != f.count) {
+                utmp_close(&f);
+                if (utmp_map_fd(fd, &f) != 0) {
+                    fprintf(stderr, "who: %s: %s\n", path, strerror(errno));
+                    return EXIT_FAILURE;
+                }
+            }
+        } else {
+            continue;
+        }
+        session_table_sync(&table, &f, 1);
+        fflush(stdout); // 파이프로 받는 감시 에이전트가 바로 볼 수 있게
+    }
+}
 
 // 메인 함수
 int main(int argc, char *argv[]) {
     // 옵션 상태를 저장할 플래그 변수
     int show_all = 0, show_boot_time = 0, show_current_term = 0;
     int show_term_status = 0, show_quick = 0;
+    const char *file = NULL;    // --file: 읽을 utmp 형식 파일
+    QueryOptions query = { 0, (time_t)INT64_MAX, NULL };
+    int query_mode = 0;         // --since, --until, --user 중 하나라도 있으면 last 형식 조회
+    int watch = 0;              // --watch: 로그인/로그아웃을 일어나는 대로 출력
+
+    static const struct option long_opts[] = {
+        {"file", required_argument, NULL, 'F'},
+        {"since", required_argument, NULL, 's'},
+        {"until", required_argument, NULL, 'u'},
+        {"user", required_argument, NULL, 'U'},
+        {"watch", no_argument, NULL, 'W'},
+        {NULL, 0, NULL, 0}
+    };
 
     int opt;
-    // getopt를 사용하여 명령줄 옵션을 파싱. "-a -b -m -T -q"
-    while ((opt = getopt(argc, argv, "abmTq")) != -1) {
+    // getopt_long을 사용하여 명령줄 옵션을 파싱. "-a -b -m -T -q"
+    while ((opt = getopt_long(argc, argv, "abmTq", long_opts, NULL)) != -1) {
         switch (opt) {
             case 'a': show_all = 1;         break;
             case 'b': show_boot_time = 1;   break;
             case 'm': show_current_term = 1;break;
             case 'T': show_term_status = 1; break;
             case 'q': show_quick = 1;       break;
+            case 'F': file = optarg;        break;
+            case 'W': watch = 1;            break;
+            case 'U': query.user = optarg; query_mode = 1; break;
+            case 's':
+            case 'u':
+                if (parse_time_arg(optarg, opt == 's' ? &query.since : &query.until) != 0) {
+                    fprintf(stderr, "who: invalid time: '%s'\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                query_mode = 1;
+                break;
             default:
-                fprintf(stderr, "사용법: %s [-abmTq]\n", argv[0]);
+                fprintf(stderr, "사용법: %s [-abmTq] [--file FILE] [--since T] [--until T] [--user U] [--watch]\n", argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
 
     // --- 옵션별 로직 처리 ---
 
-    // -q (quick) 옵션은 다른 출력 없이 사용자 목록과 수만 보여주고 종료
-    if (show_quick) {
-        struct utmp *entry;
-        char *users[1024]; // 사용자 이름을 저장할 배열
-        int count = 0;
-
-        setutent(); // utmp 파일 열기
-        while ((entry = getutent()) != NULL) {
-            if (entry->ut_type == USER_PROCESS && entry->ut_user[0] != '\0') {
-                users[count++] = strdup(entry->ut_user);
-                if (count >= 1024) break; // 배열 오버플로우 방지
-            }
-        }
-        endutent(); // utmp 파일 닫기
+    // last 형식 조회는 기본으로 로그인 기록(wtmp)을 읽는다.
+    if (query_mode) {
+        return query_sessions(file ? file : _PATH_WTMP, &query) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (watch) {
+        return watch_sessions(file ? file : _PATH_UTMP, show_term_status);
+    }
 
-        print_quick_users(users, count); // 퀵 포맷으로 출력
-        // 메모리 해제
-        for (int i = 0; i < count; i++) {
-            free(users[i]);
+    UtmpFile utmp;
+    if (utmp_open(file ? file : _PATH_UTMP, &utmp) != 0) {
+        // 기본 utmp가 없으면(컨테이너 등) getutent처럼 아무도 없는 것으로 본다.
+        if (file || errno != ENOENT) {
+            fprintf(stderr, "who: %s: %s\n", file ? file : _PATH_UTMP, strerror(errno));
+            exit(EXIT_FAILURE);
         }
+    }
+
+    // -q (quick) 옵션은 다른 출력 없이 사용자 목록과 수만 보여주고 종료
+    if (show_quick) {
+        SessionTable table = {0}; // --watch와 같은 세션 표. 자리 수만큼 늘어난다.
+        session_table_sync(&table, &utmp, 0);
+        print_quick_users(&table); // 퀵 포맷으로 출력
+        free(table.slots);
+        utmp_close(&utmp);
         return 0; // 프로그램 종료
     }
-    
+
     // -m (who am i) 옵션을 위한 현재 터미널 이름 가져오기
     char *my_tty = NULL;
     if (show_current_term) {
@@ -64,39 +508,37 @@ int main(int argc, char *argv[]) {
             my_tty += 5; // "/dev/" 부분 건너뛰기
         }
     }
-    
-    struct utmp *entry;
-    setutent(); // utmp 파일 열기
 
-    // utmp 파일을 순회하며 각 레코드를 처리
-    while ((entry = getutent()) != NULL) {
+    // utmp 레코드를 순회하며 각 레코드를 처리
+    for (size_t i = 0; i < utmp.count; i++) {
+        const struct utmp *entry = &utmp.records[i];
         int record_type = entry->ut_type;
+        time_t when = entry->ut_tv.tv_sec; // ut_tv.tv_sec은 32비트일 수 있으므로 time_t로 옮긴다.
 
         // -a 옵션 처리
-        if (show_all) { 
+        if (show_all) {
             // -a는 모든 유용한 정보를 출력하므로, 아래 기본 로직도 타야 함
             if (record_type == RUN_LVL) {
-                printf("           run-level %c        %s", entry->ut_pid, ctime((time_t *)&entry->ut_tv.tv_sec));
+                printf("           run-level %c        %s", entry->ut_pid, ctime(&when));
             } else if (record_type == BOOT_TIME) {
-                printf("           system boot      %s", ctime((time_t *)&entry->ut_tv.tv_sec));
+                printf("           system boot      %s", ctime(&when));
             } else if (record_type == DEAD_PROCESS) {
                 printf("           DEAD_PROCESS\n");
             }
         }
-        
+
         // -b 옵션 처리
         if (show_boot_time) {
             if (record_type == BOOT_TIME) {
-                printf("         system boot  %s", ctime((time_t *)&entry->ut_tv.tv_sec));
-                endutent(); // 파일을 닫고
-                return 0;   // 종료
+                printf("         system boot  %s", ctime(&when));
+                break;      // 찾았으면 루프 종료
             }
-            continue; 
+            continue;
         }
 
         // -m 옵션 처리
         if (show_current_term) {
-            if (my_tty && record_type == USER_PROCESS && strcmp(entry->ut_line, my_tty) == 0) {
+            if (my_tty && record_type == USER_PROCESS && strncmp(entry->ut_line, my_tty, UT_LINESIZE) == 0) {
                 print_entry(entry, show_term_status);
                 break; // 찾았으면 루프 종료
             }
@@ -108,7 +550,7 @@ int main(int argc, char *argv[]) {
             print_entry(entry, show_term_status);
         }
     }
-    endutent(); // utmp 파일 닫기
+    utmp_close(&utmp);
     return 0;
 }
 
@@ -118,7 +560,7 @@ int main(int argc, char *argv[]) {
  * @param entry 출력할 utmp 구조체 포인터
  * @param show_term_status 터미널 상태(+/-) 표시 여부
  */
-void print_entry(struct utmp *entry, int show_term_status) {
+void print_entry(const struct utmp *entry, int show_term_status) {
     char time_buf[30];
     time_t timestamp = entry->ut_tv.tv_sec;
 
@@ -126,15 +568,16 @@ void print_entry(struct utmp *entry, int show_term_status) {
     strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M", localtime(&timestamp));
 
     // 사용자 이름이 비어있지 않은 경우에만 출력
+    // (mmap한 레코드의 고정 길이 필드는 '\0'으로 끝나지 않을 수 있으므로 길이를 제한한다)
     if (entry->ut_user[0] != '\0') {
-        printf("%-8s ", entry->ut_user);
+        printf("%-8.*s ", UT_NAMESIZE, entry->ut_user);
     }
-    
+
     // 터미널 상태 출력 (+: 쓰기 가능, -: 쓰기 불가, ?: 확인 불가)
     if (show_term_status) {
         char term_path[64];
         struct stat term_stat;
-        snprintf(term_path, sizeof(term_path), "/dev/%s", entry->ut_line);
+        snprintf(term_path, sizeof(term_path), "/dev/%.*s", UT_LINESIZE, entry->ut_line);
         if (stat(term_path, &term_stat) == 0 && (term_stat.st_mode & S_IWGRP)) {
             printf("+ ");
         } else {
@@ -142,26 +585,28 @@ void print_entry(struct utmp *entry, int show_term_status) {
         }
     }
 
-    printf("%-12s ", entry->ut_line);
+    printf("%-12.*s ", UT_LINESIZE, entry->ut_line);
     printf("%s ", time_buf);
-    
+
     // 호스트 정보가 있다면 출력
     if(entry->ut_host[0] != '\0') {
-        printf("(%s)", entry->ut_host);
+        printf("(%.*s)", UT_HOSTSIZE, entry->ut_host);
     }
-    
+
     printf("\n");
 }
 
 
 /**
  * @brief 'who -q' 형식에 맞춰 사용자 목록과 총 인원을 출력
- * @param users 사용자 이름 배열
- * @param count 사용자 수
+ * @param t 세션 표 (로그인 세션인 자리만 센다)
  */
-void print_quick_users(char *users[], int count) {
-    for (int i = 0; i < count; i++) {
-        printf("%s ", users[i]);
+void print_quick_users(const SessionTable *t) {
+    int count = 0;
+    for (size_t i = 0; i < t->count; i++) {
+        if (!is_session(&t->slots[i])) continue;
+        printf("%.*s ", UT_NAMESIZE, t->slots[i].ut_user);
+        count++;
     }
     printf("\n# users=%d\n", count);
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#!/bin/sh
+# c_df --timeout 회귀 시험: 처음 띄운 작업 스레드가 모두 statvfs에서 멈춰도
+# 마운트별 제한 시간이 지나면 나머지를 출력하고 끝나야 한다.
+# 사용법: sh tests/c_df_timeout.sh   (0613 디렉터리에서 실행)
+set -eu
+
+cd "$(dirname "$0")/.."
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+gcc -Wall -Wextra -Wno-sign-compare -O2 -pthread -o "$tmp/c_df" c_df.c
+
+# -a이면 /proc/mounts의 첫 줄이 첫 작업이다. 그 마운트를 --slow-mount로 멈춘다.
+first=$(awk 'NR == 1 { print $2 }' /proc/mounts)
+nmounts=$(wc -l < /proc/mounts)
+
+fail=0
+# check 이름 -j값: 5초 안에 끝나고, 종료 상태 1, 멈춘 마운트를 알리고, 모든 마운트 줄을 출력해야 한다.
+check() {
+    name=$1 jobs=$2
+    rc=0
+    timeout 5 "$tmp/c_df" -a -j "$jobs" --timeout 1 --slow-mount "$first" \
+        > "$tmp/out" 2> "$tmp/err" || rc=$?
+    lines=$(($(wc -l < "$tmp/out") - 1))
+    if [ "$rc" -eq 1 ] && grep -q "^df: $first: statvfs timed out" "$tmp/err" &&
+       [ "$lines" -eq "$nmounts" ]; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name (rc=$rc, $lines/$nmounts rows)"
+        sed 's/^/  /' "$tmp/err"
+        fail=1
+    fi
+}
+
+check "-j 1, the only worker hangs on the first mount" 1
+check "-j 4, one of the first workers hangs" 4
+
+exit $fail
@@ -0,0 +1,47 @@
+#!/bin/sh
+# c_sort --csv 회귀 시험
+# 사용법: sh tests/c_sort_csv.sh   (0613 디렉터리에서 실행)
+set -eu
+
+cd "$(dirname "$0")/.."
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+gcc -Wall -Wextra -Wno-sign-compare -O2 -o "$tmp/c_sort" c_sort.c
+
+fail=0
+# check 이름 기대값 명령... : 표준 입력은 $tmp/in
+check() {
+    name=$1 expected=$2
+    shift 2
+    actual=$("$@" < "$tmp/in")
+    if [ "$actual" = "$expected" ]; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name"
+        echo "  expected: $(printf '%s' "$expected" | tr '\n' '|')"
+        echo "  actual:   $(printf '%s' "$actual" | tr '\n' '|')"
+        fail=1
+    fi
+}
+
+# -k가 없으면 레코드 전체를 비교한다. 첫 필드(따옴표)가 같아도 나머지로 순서가 정해지고 -u가 지우지 않아야 한다.
+printf '"a",z\n"a",b\n"a",m\n"a",b\n' > "$tmp/in"
+check "whole record, shared quoted first field" \
+    "$(printf '"a",b\n"a",b\n"a",m\n"a",z')" "$tmp/c_sort" --csv
+check "whole record -u keeps distinct rows" \
+    "$(printf '"a",b\n"a",m\n"a",z')" "$tmp/c_sort" --csv -u
+
+# -k는 따옴표를 벗긴 필드 값으로 비교한다: "b"와 b는 같은 키
+printf 'x,"c"\ny,a\nz,b\n' > "$tmp/in"
+check "-k unquotes the key field" \
+    "$(printf 'y,a\nz,b\nx,"c"')" "$tmp/c_sort" --csv -t, -k 2
+printf 'x,"b"\ny,a\nz,b\n' > "$tmp/in"
+check "-k -u treats quoted and bare equal" \
+    "2" sh -c "\"$tmp/c_sort\" --csv -t, -k 2 -u | wc -l | tr -d ' '"
+
+# 따옴표 안의 줄바꿈은 레코드를 나누지 않는다.
+printf '"b\nline2",1\n"a",2\n' > "$tmp/in"
+check "quoted newline stays in one record" \
+    "$(printf '"a",2\n"b\nline2",1')" "$tmp/c_sort" --csv
+
+exit $fail